@@ -1,8 +1,15 @@
+#define _GNU_SOURCE // memfd_create()
 #include <unistd.h>
-#include <math.h>
+#include <tgmath.h>
 #include <stdlib.h>
 #include <stdarg.h>
+#include <errno.h>
 #include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "asa.h"
 #include "y_dbg.h"
 
@@ -11,11 +18,102 @@ const char* window_names[] = {
   "boxcar", "hann", "flattop", "blackmanharris"
 };
 
+const char* effort_names[] = {
+  "estimate", "measure", "patient", "exhaustive"
+};
+
+const char* engine_names[] = {
+  "fft", "sdft", "fixed", "goertzel", "pruned", "padded", "auto"
+};
+
+const char* format_names[] = {
+  "u8", "db", "u16", "f32", "delta"
+};
+
+// Cosine-sum windows: a0 - a1 cos(2x) + a2 cos(4x) - a3 cos(6x) + a4 cos(8x)
+const double window_cosines[W_LAST + 1][5] = {
+  [W_BOXCAR] = { 1 },
+  // wikipedia.org/wiki/Hann_function
+  [W_HANN] = { .5, .5 },
+  // wikipedia.org/wiki/Window_function#Flat_top_window
+  [W_FLATTOP] = { .21557895, .41663158, .277263158, .083578947, .006947368 },
+  // wikipedia.org/wiki/Window_function#Blackman–Harris_window
+  [W_BLACKMANHARRIS] = { 0.35875, 0.48829, 0.14128, 0.01168 },
+};
+
 const int x = 1 << 20;
 
+
+const char *asa_check_param(const asa_param_t *p) {
+  if (p->s < 1 || p->s > x) return "-s out of limit";
+  if (p->n < p->s || p->n > x) return "-n out of limit";
+  if (p->m != 1 + p->n / 2) return "m must be 1 + n / 2";
+  if (p->d < 1) return "-d out of limit";
+  if (p->rate < 1 || p->rate > 768000) return "-f out of limit";
+  if (p->decim < 0 || p->decim > 64) return "-D out of limit";
+  if (asa_in_frames(p) > x || (long)p->d * asa_decim(p) > x)
+    return "-s or -d too large for -D";
+  if (p->r < 1 || p->r > 999) return "-r out of limit";
+  if (p->b0 < 0 || p->b0 > p->b1) return "-b rule b0 <= b1 broken";
+  if (p->b1 > p->m - 1) return "-b rule b1 <= m-1 broken";
+  if (p->b != 1 + p->b1 - p->b0) return "b must be 1 + b1 - b0";
+  if (p->q) {
+    if (p->l < 1 || p->l > p->m) return "-l out of limit";
+    if (p->b0 < 1) return "-q needs b0 >= 1";
+    if (p->p != 1.0) return "-q and -p can't be combined";
+  }
+  else {
+    if (p->l < 1 || p->l > p->b) return "-l out of limit";
+    if (p->p < 1.0 || p->p > 2.0) return "-p out of limit";
+    if (!(p->p == 1.0 || p->l != p->b))
+      return "if b == l then only p == 1 allowed";
+  }
+  if (p->format != O_U8 && p->l > ASA_HEADER_MAX_L)
+    return "-o needs l <= 65535 for the header";
+  if (p->shm && p->l > ASA_HEADER_MAX_L) return "-M needs l <= 65535";
+  if (p->w < W_FIRST || p->w > W_LAST) return "-w invalid window type";
+  if (p->c < 1 || p->c > 16) return "-c out of limit";
+  if (p->t < 1 || p->t > 64) return "-t out of limit";
+  if (p->k < 1 || p->k > 256) return "-k out of limit";
+  if (p->t > 1 && p->k > 1) return "-k and -t can't be combined";
+#ifdef ASA_FIXED
+  if (p->engine != X_FIXED && p->engine != X_GOERTZEL)
+    return "-e needs fftw, make FIXED=1 has fixed and goertzel only";
+#endif
+  if (p->engine == X_SDFT && p->n != p->s) return "-e sdft needs n == s";
+  if (p->engine == X_SDFT && (p->k > 1 || p->t > 1))
+    return "-e sdft can't be combined with -k or -t";
+  if (p->engine == X_FIXED
+      && (p->n < 16 || p->n > 32768 || (p->n & (p->n - 1))))
+    return "-e fixed needs n a power of 2 from 16 to 32768";
+  if (p->engine == X_FIXED && (p->k > 1 || p->t > 1 || p->q))
+    return "-e fixed can't be combined with -k, -t or -q";
+  if (p->engine == X_PRUNED && p->n % 16) return "-e pruned needs n % 16 == 0";
+  if (p->engine == X_PADDED && (p->n < 2 * p->s || p->n % 2))
+    return "-e padded needs an even n >= 2 s";
+  if ((p->engine == X_PRUNED || p->engine == X_PADDED) && p->t > 1)
+    return "-e pruned and padded can't be combined with -t";
+  if (!(p->smooth > 0 && p->smooth <= 1)) return "-a out of limit";
+  if (!(p->gravity >= 0 && p->gravity <= 1)) return "-g out of limit";
+  if (p->hold < 0 || p->hold > 9999) return "-H out of limit";
+  if (p->gain < 0 || p->gain > 99999) return "-A out of limit";
+  if (p->join < 1 || p->join > 256) return "-j out of limit";
+  if (p->live && p->join > 1) return "-L and -j can't be combined";
+  return NULL;
+}
+
+// Larger remainder first, of equal ones the later (wider) line
+static int asa_by_remainder(const void *a, const void *b) {
+  const double *const x = *(const double**)a, *const y = *(const double**)b;
+  if (*x != *y) return *x < *y ? 1 : -1;
+  return x < y ? 1 : -1;
+}
+
+
 int* asa_distribute_bins(int l, int b, double p) {
   y_assert(p >= 1.0 && p <= 2.0);
   y_assert_e(p == 1.0 || l != b, "for b == l avoid p > 1");
+  y_assert(l >= 1 && l <= b);
 
   int *lines = malloc(l * sizeof(int));
   if (!lines) y_oom();
@@ -26,169 +124,409 @@ int* asa_distribute_bins(int l, int b, double p) {
     for (int j = 0; j < l; j++) lines[j] = b / l;
     int missing = b - sum(lines, l);
     double step = l / (1.0 + missing);
-    for (double j = step; j < l; j += step) lines[(int)j]++;
+    for (int k = 1; k <= missing; k++) lines[(int)(k * step)]++;
 
+    y_assert(sum(lines, l) == b);
     return lines;
   }
 
-  double g[l];  
-  int wb = y_dbg_o(Y_OUT_START, "lines: approximation:");
-  for (int j = 0; j < l; j++) {
-    double r = b * (1-p) * pow(p, j) / (1 - pow(p, l));
-    g[j] = r;
-    lines[j] = ceil(r);
-    y_assert_e(lines[j] > 0, "lines[j] %d", lines[j]);
-    
-    wb += y_dbg_o(Y_OUT_CONT, " %d", lines[j]);
-    if (wb > 70) { wb = 0; y_dbg_o(Y_OUT_CONT, "\n "); };
-  }
-  int lines_sum = sum(lines, l);
-  if (wb > 30) y_dbg_o(Y_OUT_CONT, "\n ");
-  y_dbg_o(Y_OUT_END, " sum %d overshoot %d", lines_sum, lines_sum - b);
-
-  // trace g
-  y_trc_o(Y_OUT_START, "g:\n ");
-  for (int j = 0; j < l; j++) {
-    wb += y_trc_o(Y_OUT_CONT, " %g", g[j]);
-    if (wb > 70) { wb = 0; y_trc_o(Y_OUT_CONT, "\n "); };
-  }
-  y_trc_o(Y_OUT_END, "");
-
-  // Take away overdistributed bins where it hurts the least by weighting lines
-  // Criteria: line > 1 and relative distance to real g
-  int iteration = 0;
-  double weights[l];
-  y_assert(lines_sum >= b);
-  while (sum(lines, l) > b) { // no more than l iterations
-    iteration++;
-    y_trc_o(Y_OUT_START, "weights iteration %d:\n ", iteration);
-    wb = 0;
-    int zero = 1;
-    for (int j = 0; j < l; j++) {
-      if (lines[j] == 1) { weights[j] = 0; continue; }
-      if (zero) wb += y_trc_o(Y_OUT_CONT, " 0 (%d tines)", j - 1);
-      zero = 0;
-      double distance = fabs(lines[j] - g[j]);
-      double relative = log(g[j]);
-      weights[j] = distance * relative;
-      wb += y_trc_o(Y_OUT_CONT, " %.2g", weights[j]);
-      if (wb > 70) { wb = 0; y_trc_o(Y_OUT_CONT, "\n "); };
-    }
+  // The ideal widths g[j] grow geometrically and sum up to b. Lines narrower
+  // than a bin get one, they are the first ones: with suffix sums of g the
+  // others are scaled to the bins left in O(1) for every line given one.
+  double *const g = malloc(sizeof(*g) * l);
+  double *const rest = malloc(sizeof(*rest) * (l + 1));
+  double **const order = malloc(sizeof(*order) * l);
+  if (!g || !rest || !order) y_oom();
+  for (int j = 0; j < l; j++) g[j] = b * (1-p) * pow(p, j) / (1 - pow(p, l));
+  rest[l] = 0;
+  for (int j = l - 1; j >= 0; j--) rest[j] = rest[j + 1] + g[j];
 
-    double max = -INFINITY;
-    int index = 0;
-    for (int j = 0; j < l; j++)
-      if (weights[j] > max) 
-        max = weights[j], index = j;
+  int ones = 0;
+  while (ones < l && g[ones] * (b - ones) / rest[ones] < 1) ones++;
+  y_assert(ones < l); // the last line is the widest, l <= b
 
-    if (wb > 30) y_trc_o(Y_OUT_CONT, "\n ");
-    y_trc_o(Y_OUT_END, " take away bin at index %d: %d", index, lines[index]);
-    lines[index] -= 1; // Take one bin away
+  // Largest remainder apportionment: every line its width rounded down, the
+  // bins missing then go one each to the lines with the largest remainders.
+  // Wider lines have larger remainders if rounded down to the same width, so
+  // the widths stay monotone.
+  const double scale = (b - ones) / rest[ones];
+  int num = 0;
+  for (int j = 0; j < l; j++) {
+    if (j < ones) { lines[j] = 1; continue; }
+    g[j] *= scale;
+    lines[j] = floor(g[j]);
+    g[j] -= lines[j]; // the remainder
+    order[num++] = g + j;
   }
+  qsort(order, num, sizeof(*order), asa_by_remainder);
+  int missing = b - sum(lines, l);
+  y_assert(missing >= 0 && missing <= num);
+  for (int k = 0; k < missing; k++) lines[order[k] - g]++;
 
   // debug lines
-  wb = y_dbg_o(Y_OUT_START, "lines:");
+  int wb = y_dbg_o(Y_OUT_START, "lines (%d of one bin):", ones);
   for (int j = 0; j < l; j++) {
     wb += y_dbg_o(Y_OUT_CONT, " %d", lines[j]);
     if (wb > 70) { wb = 0; y_dbg_o(Y_OUT_CONT, "\n "); };
   }
   y_dbg_o(Y_OUT_END, "");
 
+  free(g);
+  free(rest);
+  free(order);
   y_assert(sum(lines, l) == b);
   return lines;
 }
 
 
-void asa_init_fft(asa_t asa) {
-  asa->d = fftw_alloc_real(asa->param.n);    // these sizes are needed by fftw3
-  asa->c = fftw_alloc_complex(asa->param.m); // rtfm fftw.org (see r2c_1d)
-  if (!asa->d || !asa->c) y_oom();
-  asa->plan = fftw_plan_dft_r2c_1d(
-    asa->param.n, asa->d, asa->c, FFTW_ESTIMATE);
+#ifndef ASA_FIXED
+// Plan the batch of ffts, the new-array execute functions use it for any
+// buffers of the same size allocated with fftw_alloc_*()
+static void asa_plan(asa_t asa) {
+  const int n = asa->param.n, m = asa->param.m;
+  const int k = asa_batch(&asa->param);
+
+  // Wisdom from an earlier run makes planning with more effort cheap
+  const char *wisdom = asa->param.wisdom;
+  if (wisdom) {
+    if (FFTW(import_wisdom_from_filename)(wisdom))
+      y_dbg("fftw wisdom imported from '%s'", wisdom);
+    else
+      y_info("no fftw wisdom imported from '%s'", wisdom);
+  }
+
+  static const unsigned flags[] = {
+    FFTW_ESTIMATE, FFTW_MEASURE, FFTW_PATIENT, FFTW_EXHAUSTIVE
+  };
+  y_assert(asa->param.e >= E_FIRST && asa->param.e <= E_LAST);
+  struct timespec t0, t1;
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  asa->plan = FFTW(plan_many_dft_r2c)(1, &n, k,
+    asa->dk, NULL, 1, n, asa->ck, NULL, 1, m, flags[asa->param.e]);
+  clock_gettime(CLOCK_MONOTONIC, &t1);
   if (!asa->plan) y_error("fftw plan failed");
+
+  y_dbg("fftw planning (%s, batch of %d) took %.3f ms",
+    effort_names[asa->param.e], k,
+    (t1.tv_sec - t0.tv_sec) * 1e3 + (t1.tv_nsec - t0.tv_nsec) / 1e6);
+  if (y_log_level >= Y_DBG) {
+    char *plan = FFTW(sprint_plan)(asa->plan);
+    y_dbg("fftw plan: %s", plan);
+    free(plan);
+  }
+
+  if (wisdom && !FFTW(export_wisdom_to_filename)(wisdom))
+    y_warn("exporting fftw wisdom to '%s' failed", wisdom);
+}
+#endif
+
+
+void asa_init_fft(asa_t asa) {
+  asa_init_window(asa);
+
+  // A batch of k ffts in one plan: k inputs of n reals, k outputs of m bins;
+  // with a spectrum per channel every channel has its own slot in the batch
+  const int n = asa->param.n, m = asa->param.m;
+  const int k = asa_batch(&asa->param);
+  asa->dk = FFTW(alloc_real)(n * k);    // these sizes are needed by fftw3
+  asa->ck = FFTW(alloc_complex)(m * k); // rtfm fftw.org (see r2c_1d)
+  if (!asa->dk || !asa->ck) y_oom();
+  asa_batch_slot(asa, 0);
+
+  int *const engine = &asa->param.engine;
+#ifdef ASA_FIXED
+  y_assert(*engine == X_FIXED || *engine == X_GOERTZEL);
+#else
+  if (*engine == X_AUTO) *engine = asa_band_engine(&asa->param);
+  if (*engine == X_FIXED || (*engine >= X_GOERTZEL && *engine <= X_PADDED))
+    y_dbg("no fftw plan of n %d for -e %s", n, engine_names[*engine]);
+  else if (!asa->plan) asa_plan(asa);
+  else y_dbg("fftw plan for n %d and batch of %d shared", n, k);
+#endif
+
+  asa_init_lines(asa);
+#ifndef ASA_FIXED
+  if (*engine == X_SDFT) asa_init_sdft(asa);
+#endif
+  if (*engine == X_FIXED) asa_init_fixed(asa);
+  if (*engine >= X_GOERTZEL && *engine <= X_PADDED) asa_init_band(asa);
+
+  // The padding is zeroed once, after planning (fftw may use the buffers)
+  memset(asa->dk, 0, sizeof(*asa->dk) * n * k);
+  asa->dirty = 0;
+
+  if (asa->param.r > 1) {
+    asa->sum = calloc(asa->param.l * asa_spectra(&asa->param),
+      sizeof(*asa->sum));
+    if (!asa->sum) y_oom();
+  }
+
+  asa_init_scale(asa);
+}
+
+
+void asa_batch_slot(asa_t asa, int j) {
+  y_assert(j >= 0 && j < asa_batch(&asa->param));
+  asa->d = asa->dk + j * asa->param.n;
+  asa->c = asa->ck + j * asa->param.m;
 }
 
 
 void asa_run_fft(asa_t asa) {
-  fftw_execute(asa->plan);
+  if (asa->fixed) { asa_fixed_run(asa); return; }
+  if (asa->band) { asa_band_run(asa); return; }
+#ifndef ASA_FIXED
+  if (asa->sdft) { asa_sdft_run(asa); return; }
+  FFTW(execute_dft_r2c)(asa->plan, asa->dk, asa->ck); // may be a thread's
+#endif
 }
 
 
 #define S16 sizeof(int16_t)
 
-int asa_read(asa_t asa) {
-  int size = S16 * asa->param.s;
-  char *p = (char*)asa->s16le;
-  
-  // Overlap? Copy rest of s16le buffer to front
-  if (asa->num_in && asa->param.s > asa->param.d) {
-    int overlap = S16 * (asa->param.s - asa->param.d);
-    y_trc("overlap %d", overlap);
-    memmove(asa->s16le, asa->s16le + asa->param.d, overlap);
-    size -= overlap;
-    p += overlap;
+// Regular files are mapped as a whole, so sequences are read without read()
+static int asa_map_input(asa_t asa, size_t size) {
+  char *map = size ? mmap(NULL, size, PROT_READ, MAP_PRIVATE, asa->fd_in, 0)
+    : NULL;
+  if (map == MAP_FAILED) {
+    y_dbg("mmap input: %s, reading it instead", y_strerr);
+    return 0;
+  }
+  if (map) madvise(map, size, MADV_SEQUENTIAL);
+  y_dbg("input file of %zu bytes mapped at %p", size, map);
+
+  asa->in_map = 1;
+  asa->ring = map;
+  asa->ring_size = size;
+  asa->avail = size;
+  return 1;
+}
+
+
+void asa_init_input(asa_t asa) {
+  struct stat st;
+  if (fstat(asa->fd_in, &st) == -1) y_error("fstat input: %s", y_strerr);
+  asa->in_file = S_ISREG(st.st_mode);
+  if (asa_decim(&asa->param) > 1) asa_init_decim(asa);
+  asa->head = 0;
+  asa->avail = 0;
+  if (asa->in_file && asa->param.live) {
+    y_info("input is a file, nothing is live");
+    asa->param.live = 0;
+  }
+  if (asa->in_file && asa_map_input(asa, st.st_size)) return;
+
+  // The ring is mapped twice back to back, so a sequence starting anywhere
+  // in the ring is contiguous in memory and overlap needs no copying. Besides
+  // the sequence it has room for reading a chunk of input at once, in live
+  // mode at least a hop, so a full ring always has stale input to drop.
+  const size_t page = sysconf(_SC_PAGESIZE);
+  const size_t frame = S16 * asa->param.c;
+  size_t room = asa->param.chunk;
+  const size_t s = asa_in_frames(&asa->param);
+  const size_t d = (size_t)asa->param.d * asa_decim(&asa->param);
+  if (asa->param.live) room = max(room, frame * min(d, s));
+  const size_t need = frame * s + room;
+  const size_t size = (need + page - 1) / page * page;
+
+#ifdef __linux__
+  int fd = memfd_create("auspan-ring", MFD_CLOEXEC);
+  if (fd == -1) y_error("memfd_create: %s", y_strerr);
+#else
+  char name[32];
+  snprintf(name, sizeof(name), "/auspan-ring-%d", (int)getpid());
+  int fd = shm_open(name, O_RDWR|O_CREAT|O_EXCL, 0600);
+  if (fd == -1) y_error("shm_open: %s", y_strerr);
+  shm_unlink(name);
+#endif
+  if (ftruncate(fd, size) == -1) y_error("ftruncate ring: %s", y_strerr);
+
+  char *ring = mmap(NULL, 2 * size, PROT_NONE, MAP_PRIVATE|MAP_ANON, -1, 0);
+  if (ring == MAP_FAILED) y_error("mmap ring: %s", y_strerr);
+  for (int i = 0; i < 2; i++) {
+    void *half = mmap(ring + i * size, size, PROT_READ|PROT_WRITE,
+      MAP_SHARED|MAP_FIXED, fd, 0);
+    if (half == MAP_FAILED) y_error("mmap ring: %s", y_strerr);
   }
+  close(fd);
+  y_dbg("input ring of %zu bytes mapped twice at %p", size, ring);
 
+  asa->ring = ring;
+  asa->ring_size = size;
+}
+
+
+// Skip input: seek in files, read pipes in chunks as big as the ring
+static int asa_skip(asa_t asa) {
   const int in = asa->fd_in;
 
-  // Skip? Dummy read (seek doesn't work on pipes)
-  if (asa->num_in && asa->param.s < asa->param.d) {
-    int skip = S16 * (asa->param.d - asa->param.s);
-    while (1) {
-      char dummy[2000];
-      int size = min(skip, sizeof(dummy));
-      ssize_t len = read(in, dummy, size);
-      y_trc("skip: read(%d, dummy, %d): %ld", in, size, len);
+  if (asa->in_map) return 0; // everything up to the end of file is available
 
-      if (len == size) break;
-      if (len == 0) return 0; // End of file
-      if (len == -1) y_error("skipping: %s", y_strerr);
+  if (asa->in_file) {
+    off_t pos = lseek(in, asa->skip, SEEK_CUR);
+    y_trc("skip: lseek(%d, %zu, SEEK_CUR): %lld", in, asa->skip,
+      (long long)pos);
+    if (pos == -1) y_error("skipping: %s", y_strerr);
+    asa->skip = 0;
+    return 1;
+  }
 
-      size -= len;
-    }
+  while (asa->skip) {
+    size_t size = min(asa->skip, asa->ring_size);
+    ssize_t len = read(in, asa->ring, size); // whole ring is stale anyway
+    y_trc("skip: read(%d, ring, %zu): %ld", in, size, len);
+
+    if (len == 0) return 0; // End of file
+    if (len == -1 && errno == EAGAIN) return -1;
+    if (len == -1) y_error("skipping: %s", y_strerr);
+
+    asa->skip -= len;
   }
+  return 1;
+}
+
+
+// Poll without waiting
+static int asa_ready(int fd, short events) {
+  struct pollfd pfd = { .fd = fd, .events = events };
+  return poll(&pfd, 1, 0) == 1;
+}
 
-  while (1) {
-    y_assert(p + size == (char*)(asa->s16le + asa->param.s));
 
-    ssize_t len = read(in, p, size);
-    y_trc("seq #%d: read(%d, p, %d): %ld", asa->num_in, in, size, len);
+// Live mode: drop whole hops (d, but at most s) of the oldest input until
+// less than a hop more than a sequence is left, so the sequence at head is the
+// newest one on the grid of hops
+static void asa_drop_stale(asa_t asa, size_t s, size_t hop) {
+  if (asa->avail < s + hop) return;
+
+  const size_t stale = (asa->avail - s) / hop * hop;
+  asa->head = (asa->head + stale) % asa->ring_size;
+  asa->avail -= stale;
+  asa->gap = 1;
+  ASA_COUNT(asa, N_STALE, stale);
+  y_trc("seq #%d: %zu bytes of stale input dropped", asa->num_in, stale);
+}
+
 
-    // Done!
-    if (len == size) {
-      asa->num_in++;
-      return 1;
+// Live mode: read everything there is, without waiting if there is a sequence
+// already, then drop the stale input. Input faster than real time would keep
+// it reading, so it reads at most a ring full. Like asa_read() 1, 0 or -1.
+static int asa_drain(asa_t asa, size_t s, size_t hop) {
+  for (size_t total = 0; asa->avail < s
+      || (total < asa->ring_size && asa_ready(asa->fd_in, POLLIN)); ) {
+    if (asa->avail == asa->ring_size) asa_drop_stale(asa, s, hop);
+
+    char *p = asa->ring + asa->head + asa->avail;
+    size_t size = asa->ring_size - asa->avail;
+    ssize_t len = read(asa->fd_in, p, size);
+    y_trc("seq #%d: drain read(%d, p, %zu): %ld", asa->num_in, asa->fd_in,
+      size, len);
+
+    // End of file, after the newest sequence
+    if (len == 0 && asa->avail >= s) break;
+    if (len == 0) {
+      y_info("end of file after reading %i sequences(s)", asa->num_in);
+      if (asa->avail) y_warn("%zu bytes discarded", asa->avail);
+      return 0;
+    }
+
+    if (len == -1 && errno == EAGAIN) {
+      if (asa->avail >= s) break;
+      return -1;
     }
+    if (len == -1) y_error("read pcm: %s", y_strerr);
+
+    asa->avail += len;
+    total += len;
+  }
+
+  asa_drop_stale(asa, s, hop);
+  return 1;
+}
+
+
+int asa_read(asa_t asa) {
+  // s and d count frames of c interleaved samples
+  const size_t frame = S16 * asa->param.c;
+  const size_t s = frame * asa_in_frames(&asa->param);
+  const size_t d = frame * asa->param.d * asa_decim(&asa->param);
+
+  // Next sequence? Advance by d, with overlap (d < s) the rest of the
+  // sequence stays in the ring, and skip (d > s) what isn't read yet
+  if (asa->s16le) {
+    size_t step = min(d, asa->avail);
+    asa->head += step;
+    asa->avail -= step;
+    if (!asa->in_map) asa->head %= asa->ring_size;
+    asa->skip = d - step;
+    asa->s16le = NULL;
+    asa->gap = 0;
+    if (d > s) ASA_COUNT(asa, N_SKIPPED, d - s);
+  }
+  if (asa->skip) {
+    int result = asa_skip(asa);
+    if (result < 1) return result;
+  }
+
+  if (asa->param.live) {
+    int result = asa_drain(asa, s, min(d, s));
+    if (result < 1) return result;
+  }
+
+  // Read as much as there is room in the ring; read() on a pipe returns what
+  // is available, so this doesn't wait longer than reading s bytes would.
+  // Non-blocking input returns -1 when it would block, call again later.
+  while (asa->avail < s) {
+    char *p = asa->ring + asa->head + asa->avail;
+    size_t size = asa->ring_size - asa->avail;
+    ssize_t len = asa->in_map ? 0 : read(asa->fd_in, p, size);
+    y_trc("seq #%d: read(%d, p, %zu): %ld", asa->num_in, asa->fd_in, size, len);
 
     // End of file!
     if (len == 0) {
       y_info("end of file after reading %i sequences(s)", asa->num_in);
-      ssize_t unused = p - (char*)asa->s16le;
-      if (unused) y_warn("%ld bytes discarded", unused);
+      if (asa->avail) y_warn("%zu bytes discarded", asa->avail);
       return 0;
     }
 
     // Error!
+    if (len == -1 && errno == EAGAIN) return -1;
     if (len == -1) y_error("read pcm: %s", y_strerr);
-    
-    size -= len;
-    p += len;
+
+    asa->avail += len;
+    if (asa->avail < s) ASA_COUNT(asa, N_SHORT_READS, 1);
   }
+
+  // Done!
+  asa->s16le = (int16_t*)(asa->ring + asa->head);
+  if (asa->decim) asa_decimate(asa);
+  asa->num_in++;
+  ASA_COUNT(asa, N_SEQUENCES, 1);
+  return 1;
 }
 
 
-void asa_pad_and_window(asa_t asa) {
-  memset(asa->d, 0, sizeof(*asa->d) * asa->param.n);
+void asa_init_window(asa_t asa) {
+  asa->w = FFTW(alloc_real)(asa->param.s);
+  if (!asa->w) y_oom();
 
   const double N = M_PI / (asa->param.n - 1);
   const int i0 = (asa->param.n - asa->param.s) / 2;
   const int i1 = i0 + asa->param.s;
 
+  #define WINDOW(f) \
+    for (int i = i0; i < i1; i++) asa->w[i - i0] = (f)
+
   y_assert(asa->param.w >= W_FIRST && asa->param.w <= W_LAST);
+  if (asa->param.q) { // the kernels of the constant-Q lines have the window
+    WINDOW(1);
+    return;
+  }
+  const double a0 = window_cosines[asa->param.w][0],
+    a1 = window_cosines[asa->param.w][1], a2 = window_cosines[asa->param.w][2],
+    a3 = window_cosines[asa->param.w][3], a4 = window_cosines[asa->param.w][4];
   switch (asa->param.w) {
 
-    #define WINDOW(f) \
-      for (int i = i0; i < i1; i++) asa->d[i] = asa->s16le[i] * (f)
     #define COS2 cos(2 * i * N)
     #define COS4 cos(4 * i * N)
     #define COS6 cos(6 * i * N)
@@ -199,82 +537,607 @@ void asa_pad_and_window(asa_t asa) {
     } break;
 
     case W_HANN: {
-      // wikipedia.org/wiki/Hann_function
-      const double a0=.5;
-      WINDOW(a0 - a0 * COS2);
+      WINDOW(a0 - a1 * COS2);
     } break;
 
     case W_FLATTOP: {
-      // wikipedia.org/wiki/Window_function#Flat_top_window
-      const double a0=.21557895, a1=.41663158, a2=.277263158,
-        a3=.083578947, a4=.006947368;
       WINDOW(a0 - a1 * COS2 + a2 * COS4 - a3 * COS6 + a4 * COS8);
     } break;
 
     case W_BLACKMANHARRIS: {
-      // wikipedia.org/wiki/Window_function#Blackman–Harris_window
-      const double a0=0.35875, a1=0.48829, a2=0.14128, a3=0.01168;
       WINDOW(a0 - a1 * COS2 + a2 * COS4 - a3 * COS6);
     } break;
   }
 }
 
 
+void asa_pad_and_window(asa_t asa) {
+#ifndef ASA_FIXED
+  if (asa->sdft) { asa_sdft_window(asa); return; }
+#endif
+  if (asa->fixed) { asa_fixed_window(asa); return; }
+
+  const int s = asa->param.s, c = asa->param.c, i0 = (asa->param.n - s) / 2;
+  const int16_t *const s16le = asa->s16le;
+  const asa_real_t *const w = asa->w;
+  asa_real_t *const d = asa->d + i0;
+
+  // The padding stays zero but for the bins and lines asa_lines() wrote to
+  // the front (dirty); goertzel and padded read just the samples
+  const int dirty = asa->dirty, engine = asa->param.engine;
+  if (engine != X_GOERTZEL && engine != X_PADDED && dirty) {
+    memset(asa->d, 0, sizeof(*asa->d) * min(dirty, i0));
+    if (dirty > i0 + s) memset(d + s, 0, sizeof(*d) * (dirty - i0 - s));
+  }
+
+  // De-interleave while windowing, so the frames are read only once
+  if (c <= 1) {
+    for (int i = 0; i < s; i++) d[i] = s16le[i] * w[i];
+  }
+  else if (asa->chan >= 0) {
+    const int16_t *const p = s16le + asa->chan;
+    for (int i = 0; i < s; i++) d[i] = p[i * c] * w[i];
+  }
+  else {
+    const asa_real_t rc = 1.0 / c;
+    for (int i = 0; i < s; i++) {
+      int mix = 0;
+      for (int j = 0; j < c; j++) mix += s16le[i * c + j];
+      d[i] = mix * rc * w[i];
+    }
+  }
+}
+
+
+// Magnitude kernels: d[i] = |c[i]| for i in [0, b), the squared magnitude is
+// used as is, no overflow-safe scaling like hypot() is needed for fft output
+
+static void asa_mag_scalar(asa_real_t *d, const FFTW(complex) *c, int b) {
+  for (int i = 0; i < b; i++)
+    d[i] = sqrt(c[i][0] * c[i][0] + c[i][1] * c[i][1]);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+
+#ifdef ASA_FLOAT
+
+__attribute__((target("sse2")))
+static void asa_mag_sse2(asa_real_t *d, const FFTW(complex) *c, int b) {
+  int i = 0;
+  for (; i + 4 <= b; i += 4) {
+    __m128 a = _mm_loadu_ps(c[i]), e = _mm_loadu_ps(c[i + 2]);
+    __m128 re = _mm_shuffle_ps(a, e, _MM_SHUFFLE(2, 0, 2, 0));
+    __m128 im = _mm_shuffle_ps(a, e, _MM_SHUFFLE(3, 1, 3, 1));
+    __m128 sq = _mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im));
+    _mm_storeu_ps(d + i, _mm_sqrt_ps(sq));
+  }
+  asa_mag_scalar(d + i, c + i, b - i);
+}
+
+__attribute__((target("avx2")))
+static void asa_mag_avx2(asa_real_t *d, const FFTW(complex) *c, int b) {
+  int i = 0;
+  for (; i + 8 <= b; i += 8) {
+    __m256 a = _mm256_loadu_ps(c[i]), e = _mm256_loadu_ps(c[i + 4]);
+    // shuffle works within 128-bit lanes: re0 re1 re4 re5 | re2 re3 re6 re7
+    __m256 re = _mm256_shuffle_ps(a, e, _MM_SHUFFLE(2, 0, 2, 0));
+    __m256 im = _mm256_shuffle_ps(a, e, _MM_SHUFFLE(3, 1, 3, 1));
+    __m256 sq = _mm256_add_ps(_mm256_mul_ps(re, re), _mm256_mul_ps(im, im));
+    __m256d m = _mm256_castps_pd(_mm256_sqrt_ps(sq));
+    m = _mm256_permute4x64_pd(m, _MM_SHUFFLE(3, 1, 2, 0));
+    _mm256_storeu_ps(d + i, _mm256_castpd_ps(m));
+  }
+  asa_mag_scalar(d + i, c + i, b - i);
+}
+
+#else
+
+__attribute__((target("sse2")))
+static void asa_mag_sse2(asa_real_t *d, const FFTW(complex) *c, int b) {
+  int i = 0;
+  for (; i + 2 <= b; i += 2) {
+    __m128d a = _mm_loadu_pd(c[i]), e = _mm_loadu_pd(c[i + 1]);
+    __m128d re = _mm_unpacklo_pd(a, e), im = _mm_unpackhi_pd(a, e);
+    __m128d sq = _mm_add_pd(_mm_mul_pd(re, re), _mm_mul_pd(im, im));
+    _mm_storeu_pd(d + i, _mm_sqrt_pd(sq));
+  }
+  asa_mag_scalar(d + i, c + i, b - i);
+}
+
+__attribute__((target("avx2")))
+static void asa_mag_avx2(asa_real_t *d, const FFTW(complex) *c, int b) {
+  int i = 0;
+  for (; i + 4 <= b; i += 4) {
+    __m256d a = _mm256_loadu_pd(c[i]), e = _mm256_loadu_pd(c[i + 2]);
+    // unpack works within 128-bit lanes: re0 re2 | re1 re3
+    __m256d re = _mm256_unpacklo_pd(a, e), im = _mm256_unpackhi_pd(a, e);
+    __m256d sq = _mm256_add_pd(_mm256_mul_pd(re, re), _mm256_mul_pd(im, im));
+    __m256d m = _mm256_sqrt_pd(sq);
+    _mm256_storeu_pd(d + i, _mm256_permute4x64_pd(m, _MM_SHUFFLE(3, 1, 2, 0)));
+  }
+  asa_mag_scalar(d + i, c + i, b - i);
+}
+
+#endif
+#endif
+
+
+void asa_init_lines(asa_t asa) {
+  asa->mag = asa_mag_scalar;
+  const char *kernel = "scalar";
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    asa->mag = asa_mag_avx2, kernel = "avx2";
+  else if (__builtin_cpu_supports("sse2"))
+    asa->mag = asa_mag_sse2, kernel = "sse2";
+#endif
+  y_dbg("magnitude kernel: %s", kernel);
+
+  if (asa->param.q) { asa_init_cq(asa); return; }
+
+  // Multiply by reciprocals instead of dividing by g[i] for every line
+  asa->rg = malloc(sizeof(*asa->rg) * asa->param.l);
+  if (!asa->rg) y_oom();
+  for (int i = 0; i < asa->param.l; i++) asa->rg[i] = 1.0 / asa->param.g[i];
+}
+
+
 void asa_lines(asa_t asa) {
   y_assert(asa->param.b0 <= asa->param.b1);
 
-  double *const d = asa->d;
-  fftw_complex *const c = asa->c;
+  asa_real_t *const d = asa->d;
+  const int l = asa->param.l;
+  asa_real_t max_mag = 0; // magnitudes are non-negative
+  int i;
 
-  // calculate magnitudes from c[b0:b1] to d[1:b] (note 1 as first index for d)
-  int b0 = asa->param.b0 - 1, b = asa->param.b + 1;
-  for (int i = 1; i < b; i++) {
-    d[i] = hypot(c[i + b0][0], c[i + b0][1]);
+  if (asa->cq || asa->fixed) {
+    if (asa->cq) asa_cq_lines(asa);
+    else asa_fixed_lines(asa);
+    for (i = 0; i < l; i++) if (max_mag < d[i]) max_mag = d[i];
   }
+  else {
+    // calculate magnitudes from c[b0:b1] to d[0:b-1]
+    asa->mag(d, asa->c + asa->param.b0, asa->param.b);
 
-  asa->max_mag = 0; // hypot() is non-negative, so 0 is the minimum possible
+    // combine bins from d[0:b-1] to d[0:l-1] and simultaneously find maximum
+    // magnitude of lines; line i starts at bin j >= i, so it is stored after
+    // its bins are summed up and no unused bin is overwritten
+    const int *const g = asa->param.g;
+    const asa_real_t *const rg = asa->rg;
+    int j = 0;
+    for (i = 0; i < l; i++) {
+      asa_real_t sum = 0;
+      for (const int end = j + g[i]; j < end; j++) sum += d[j];
+      d[i] = sum * rg[i];
 
-  // combine bins from d[1:b] to d[0:l-1] (note from 1 to 0 as first index)
-  // and simultaneously find maximum magnitude of lines
-  int l = asa->param.l, *g = asa->param.g, j = 0, i;
-  for (i = 0; i < l; i++) {
-    d[i] = 0;
-    for (int k = 0; k < g[i]; k++) d[i] += d[j++];
-    d[i] /= (double)g[i];
+      if (max_mag < d[i]) max_mag = d[i];
+    }
+  }
+  asa->max_mag = max_mag;
 
+  // help debugging by setting -1 after the lines; asa_pad_and_window()
+  // clears what was written here from the padding
+  if (i < asa->param.n) d[i] = -1;
+  const int end = asa->cq || asa->fixed ? l + 1 : max(asa->param.b, l + 1);
+  asa->dirty = max(asa->dirty, min(end, asa->param.n));
+}
+
+
+int asa_average(asa_t asa) {
+  const int r = asa->param.r;
+  if (r == 1) return 1;
+
+  // A spectrum is written every r sequences, so a running sum of the lines is
+  // enough: O(l) per sequence and no need to keep the r sequences around.
+  // Channels come in order, so the last r-th sequence completes them all.
+  const int l = asa->param.l, spectra = asa_spectra(&asa->param);
+  asa_real_t *const d = asa->d;
+  asa_real_t *const sum = asa->sum + (spectra > 1 ? l * asa->chan : 0);
+  for (int i = 0; i < l; i++) sum[i] += d[i];
+  if (++asa->num_sum <= (r - 1) * spectra) return 0;
+
+  asa->max_mag = 0;
+  for (int i = 0; i < l; i++) {
+    d[i] = sum[i] / r;
+    sum[i] = 0;
     if (asa->max_mag < d[i]) asa->max_mag = d[i];
   }
+  if (asa->num_sum == r * spectra) asa->num_sum = 0;
+  return 1;
+}
 
-  // help debugging by setting -1 then clearing
-  if (i < asa->param.n) d[i] = -1;
-  i++;
-  for (; i < asa->param.n; i++) d[i] = 0;
+
+void asa_init_scale(asa_t asa) {
+  const asa_param_t *const p = &asa->param;
+  if (p->smooth == 1 && !p->gravity && !p->hold && !p->gain) return;
+
+  const int l = p->l, spectra = asa_spectra(p);
+  asa_real_t *state = malloc(sizeof(*state) * (4 * l + 1) * spectra);
+  if (!state) y_oom();
+  asa->smooth = state;
+  asa->level = state + l * spectra;
+  asa->fall = state + 2 * l * spectra;
+  asa->hold = state + 3 * l * spectra;
+  asa->gain = state + 4 * l * spectra;
+
+  for (int i = 0; i < l * spectra; i++) {
+    asa->smooth[i] = asa->level[i] = 0;
+    asa->fall[i] = p->gravity ? 0 : 2;
+    asa->hold[i] = -1;
+  }
+  for (int i = 0; i < spectra; i++) asa->gain[i] = 0;
+  y_dbg("scaling: smooth %g gravity %g hold %d gain %d", p->smooth,
+    p->gravity, p->hold, p->gain);
+}
+
+
+// Lines of a channel and the constants for the scaling kernels
+typedef struct asa_scaling_t {
+  const asa_real_t *d;
+  asa_real_t *smooth, *level, *fall, *hold;
+  asa_real_t rgain, a, h, g, f0;
+} asa_scaling_t;
+
+
+// Lines i to l - 1: normalize, smooth exponentially, hold peaks for h
+// spectrums, then fall with gravity, faster and faster. No branches, the
+// conditions are selects like in the SIMD kernel.
+static void asa_scale_scalar(const asa_scaling_t *k, int i, int l) {
+  for (; i < l; i++) {
+    const asa_real_t s = k->smooth[i] + k->a * (k->d[i] * k->rgain
+      - k->smooth[i]);
+    const asa_real_t old = k->level[i], faster = k->fall[i] + k->g;
+    const int peak = s >= old;
+    const asa_real_t held = peak ? k->h : k->hold[i] - 1; // held while >= 0
+    const asa_real_t fallen = old - faster > s ? old - faster : s;
+
+    k->smooth[i] = s;
+    k->level[i] = peak ? s : held >= 0 ? old : fallen;
+    k->fall[i] = peak ? k->f0 : held >= 0 ? k->fall[i] : faster;
+    k->hold[i] = held >= 0 ? held : -1;
+  }
+}
+
+
+// SSE2 is part of x86-64, selects are and, andnot and or of compare masks
+#ifdef __SSE2__
+#include <emmintrin.h>
+#ifdef ASA_FLOAT
+
+static int asa_scale_sse2(const asa_scaling_t *k, int l) {
+  #define SEL(m, x, y) _mm_or_ps(_mm_and_ps(m, x), _mm_andnot_ps(m, y))
+  const __m128 rgain = _mm_set1_ps(k->rgain), a = _mm_set1_ps(k->a);
+  const __m128 h = _mm_set1_ps(k->h), g = _mm_set1_ps(k->g);
+  const __m128 f0 = _mm_set1_ps(k->f0), one = _mm_set1_ps(1);
+  const __m128 zero = _mm_setzero_ps(), none = _mm_set1_ps(-1);
+  int i = 0;
+  for (; i + 4 <= l; i += 4) {
+    __m128 sm = _mm_loadu_ps(k->smooth + i), old = _mm_loadu_ps(k->level + i);
+    __m128 fall = _mm_loadu_ps(k->fall + i), hold = _mm_loadu_ps(k->hold + i);
+    __m128 new = _mm_mul_ps(_mm_loadu_ps(k->d + i), rgain);
+    __m128 s = _mm_add_ps(sm, _mm_mul_ps(a, _mm_sub_ps(new, sm)));
+    __m128 faster = _mm_add_ps(fall, g);
+    __m128 peak = _mm_cmpge_ps(s, old);
+    __m128 held = SEL(peak, h, _mm_sub_ps(hold, one));
+    __m128 keep = _mm_cmpge_ps(held, zero);
+    __m128 fallen = _mm_max_ps(_mm_sub_ps(old, faster), s);
+    _mm_storeu_ps(k->smooth + i, s);
+    _mm_storeu_ps(k->level + i, SEL(peak, s, SEL(keep, old, fallen)));
+    _mm_storeu_ps(k->fall + i, SEL(peak, f0, SEL(keep, fall, faster)));
+    _mm_storeu_ps(k->hold + i, SEL(keep, held, none));
+  }
+  #undef SEL
+  return i;
+}
+
+#else
+
+static int asa_scale_sse2(const asa_scaling_t *k, int l) {
+  #define SEL(m, x, y) _mm_or_pd(_mm_and_pd(m, x), _mm_andnot_pd(m, y))
+  const __m128d rgain = _mm_set1_pd(k->rgain), a = _mm_set1_pd(k->a);
+  const __m128d h = _mm_set1_pd(k->h), g = _mm_set1_pd(k->g);
+  const __m128d f0 = _mm_set1_pd(k->f0), one = _mm_set1_pd(1);
+  const __m128d zero = _mm_setzero_pd(), none = _mm_set1_pd(-1);
+  int i = 0;
+  for (; i + 2 <= l; i += 2) {
+    __m128d sm = _mm_loadu_pd(k->smooth + i), old = _mm_loadu_pd(k->level + i);
+    __m128d fall = _mm_loadu_pd(k->fall + i), hold = _mm_loadu_pd(k->hold + i);
+    __m128d new = _mm_mul_pd(_mm_loadu_pd(k->d + i), rgain);
+    __m128d s = _mm_add_pd(sm, _mm_mul_pd(a, _mm_sub_pd(new, sm)));
+    __m128d faster = _mm_add_pd(fall, g);
+    __m128d peak = _mm_cmpge_pd(s, old);
+    __m128d held = SEL(peak, h, _mm_sub_pd(hold, one));
+    __m128d keep = _mm_cmpge_pd(held, zero);
+    __m128d fallen = _mm_max_pd(_mm_sub_pd(old, faster), s);
+    _mm_storeu_pd(k->smooth + i, s);
+    _mm_storeu_pd(k->level + i, SEL(peak, s, SEL(keep, old, fallen)));
+    _mm_storeu_pd(k->fall + i, SEL(peak, f0, SEL(keep, fall, faster)));
+    _mm_storeu_pd(k->hold + i, SEL(keep, held, none));
+  }
+  #undef SEL
+  return i;
+}
+
+#endif
+#endif
+
+
+// Normalize by the gain, the maximum of the spectrum or with auto-gain a
+// reference falling slowly from the largest maximum, then the kernels. The
+// state is allocated by asa_init_scale(), nothing is allocated here.
+void asa_scale(asa_t asa, asa_real_t *v) {
+  const asa_param_t *const p = &asa->param;
+  const int l = p->l;
+  const asa_real_t *const d = asa->d;
+
+  if (!asa->level) {
+    for (int i = 0; i < l; i++)
+      v[i] = asa->max_mag > 0 ? 255 * d[i] / asa->max_mag : 0;
+    return;
+  }
+
+  const int chan = asa_spectra(p) > 1 ? asa->chan : 0;
+  asa_real_t gain = asa->max_mag;
+  if (p->gain) {
+    const asa_real_t decayed = asa->gain[chan] * pow(0.5, 1.0 / p->gain);
+    if (gain < decayed) gain = decayed;
+    asa->gain[chan] = gain;
+  }
+
+  // Without gravity a line falls at once: a fall of 2 is more than full scale
+  const asa_scaling_t k = {
+    .d = d, .smooth = asa->smooth + l * chan, .level = asa->level + l * chan,
+    .fall = asa->fall + l * chan, .hold = asa->hold + l * chan,
+    .rgain = gain > 0 ? 1 / gain : 0, .a = p->smooth, .h = p->hold,
+    .g = p->gravity, .f0 = p->gravity ? 0 : 2,
+  };
+  int i = 0;
+#ifdef __SSE2__
+  i = asa_scale_sse2(&k, l);
+#endif
+  asa_scale_scalar(&k, i, l);
+
+  for (i = 0; i < l; i++) v[i] = 255 * (k.level[i] < 1 ? k.level[i] : 1);
+}
+
+
+// Largest frame of the format: the delta frame has a key byte and at most a
+// byte per line (a skip token stands for 2 lines or more) plus a token per
+// 128 lines of literals, see asa_delta()
+static size_t asa_frame_size(const asa_param_t *p) {
+  switch (p->format) {
+    case O_U16: return 2 * p->l;
+    case O_F32: return 4 * p->l;
+    case O_DELTA: return 2 + p->l + 2 * ((p->l + 127) / 128);
+    default: return p->l;
+  }
+}
+
+
+void asa_init_output(asa_t asa) {
+  const asa_param_t *const p = &asa->param;
+  const int spectra = asa_spectra(p);
+  y_assert(p->join >= 1);
+
+  asa->out_size = asa_frame_size(p) * p->join;
+  asa->out = malloc(asa->out_size);
+  if (!asa->out) y_oom();
+  asa->out_len = asa->out_num = 0;
+  if (p->format == O_DELTA) {
+    asa->prev = calloc(p->l * spectra, 1);
+    if (!asa->prev) y_oom();
+  }
+  if (p->shm) {
+    y_assert(p->join == spectra && p->format != O_DELTA);
+    asa_init_shm(asa);
+    return;
+  }
+  if (p->format == O_U8) return; // raw as ever, without header
+
+  // Little endian like the pcm input
+  const uint32_t hop = p->d * p->r * asa_decim(p);
+  const int16_t floor = p->format == O_DB ? p->floor : 0;
+  const uint8_t header[ASA_HEADER_SIZE] = {
+    'A', 'S', 'P', 'N', ASA_HEADER_VERSION, p->format, spectra, 0,
+    p->l, p->l >> 8, floor, floor >> 8, hop, hop >> 8, hop >> 16, hop >> 24,
+  };
+  if (write(asa->fd_out, header, sizeof(header)) != sizeof(header))
+    y_error("write header: %s", y_strerr);
+  y_dbg("output %s, header written", format_names[p->format]);
+}
+
+
+// Changed lines of the u8 frame against the last one written of the channel:
+// runs of unchanged lines and runs of literals, see asa.h. A single unchanged
+// line between changed ones is cheaper as a literal than as a skip token.
+static size_t asa_delta(uint8_t *out, const uint8_t *u8, uint8_t *prev,
+    int l, int key) {
+  size_t len = 0;
+  out[len++] = key;
+  if (key) memset(prev, 0, l);
+  for (int i = 0; i < l; ) {
+    int run = 0;
+    while (i + run < l && run < 128 && u8[i + run] == prev[i + run]) run++;
+    if (run) { out[len++] = run - 1; i += run; continue; }
+    while (i + run < l && run < 128 && (u8[i + run] != prev[i + run]
+        || (i + run + 1 < l && u8[i + run + 1] != prev[i + run + 1])))
+      run++;
+    out[len++] = 0x7f + run;
+    memcpy(out + len, u8 + i, run);
+    memcpy(prev + i, u8 + i, run);
+    len += run;
+    i += run;
+  }
+  return len;
+}
+
+
+// Encode the scaled lines v (0 to 255) to out in the format, return the size
+static size_t asa_encode(asa_t asa, const asa_real_t *v, uint8_t *out) {
+  const asa_param_t *const p = &asa->param;
+  const int l = p->l;
+
+  switch (p->format) {
+    case O_U8: {
+      for (int i = 0; i < l; i++) out[i] = (uint8_t)v[i];
+    } return l;
+
+    case O_DB: {
+      // floor dB and below is 0, 0 dB (full scale) is 255
+      for (int i = 0; i < l; i++) {
+        const asa_real_t db = v[i] > 0 ? 20 * log10(v[i] / 255) : p->floor;
+        const asa_real_t x = 1 - db / p->floor;
+        out[i] = (uint8_t)(255 * (x > 0 ? x : 0));
+      }
+    } return l;
+
+    case O_U16: {
+      for (int i = 0; i < l; i++) {
+        const uint16_t u16 = 257 * v[i];
+        out[2 * i] = u16;
+        out[2 * i + 1] = u16 >> 8;
+      }
+    } return 2 * l;
+
+    case O_F32: {
+      for (int i = 0; i < l; i++) {
+        const float f32 = v[i] / 255;
+        memcpy(out + 4 * i, &f32, 4);
+      }
+    } return 4 * l;
+
+    case O_DELTA: {
+      uint8_t u8[l];
+      for (int i = 0; i < l; i++) u8[i] = (uint8_t)v[i];
+      const int spectra = asa_spectra(p);
+      const int chan = spectra > 1 ? asa->chan : 0;
+      const int key = asa->num_out / spectra % ASA_KEY_FRAMES == 0;
+      return asa_delta(out, u8, asa->prev + l * chan, l, key);
+    }
+  }
+  y_assert(0);
+  return 0;
+}
+
+
+void asa_flush(asa_t asa) {
+  if (!asa->out_len) return;
+
+  // The shared memory gets whole frames only
+  if (asa->shm) {
+    if (asa->out_num == asa->param.join) asa_shm_publish(asa);
+    asa->out_len = asa->out_num = 0;
+    return;
+  }
+
+  for (size_t done = 0; done < asa->out_len; ) {
+    ssize_t result = write(asa->fd_out, asa->out + done, asa->out_len - done);
+    y_trc("%d spectrum(s) write(%d, p, %zu): %ld", asa->out_num, asa->fd_out,
+      asa->out_len - done, result);
+    if (result == -1 && errno == EINTR) continue;
+    if (result == -1) y_error("write: %s", y_strerr);
+    done += result;
+  }
+  ASA_COUNT(asa, N_WRITES, 1);
+  asa->out_len = asa->out_num = 0;
 }
 
 
 void asa_write(asa_t asa) {
   y_assert(asa->param.b0 <= asa->param.b1);
+  y_assert(asa->out);
 
   const int l = asa->param.l;
-  const int fd = asa->fd_out;
-  uint8_t spectrum[l];
+  asa_real_t v[l];
 
-  for (int i = 0; i < l; i++) {
-    spectrum[i] = (uint8_t)(255 * asa->d[i] / asa->max_mag);
+  // Before a spectrum is dropped, so the scaling goes on in time
+  asa_scale(asa, v);
+
+  // Live mode doesn't wait for the output: if it isn't ready for the spectrum
+  // (of the first channel), the spectrums of all channels are dropped. The
+  // shared memory is always ready.
+  if (asa->param.live && !asa->shm) {
+    if (asa->chan <= 0) asa->drop = !asa_ready(asa->fd_out, POLLOUT);
+    if (asa->drop) {
+      y_trc("spectrum #%d dropped", asa->num_out);
+      ASA_COUNT(asa, N_DROPPED, 1);
+      return;
+    }
   }
 
-  ssize_t result = write(fd, spectrum, l);
-  y_trc("spectrum #%d write(%d, p, %d): %ld", asa->num_out, fd, l, result);
-  if (result == -1) y_error("write: %s", y_strerr);
+  // Frames are collected for j spectrums, then written with one write()
+  asa->out_len += asa_encode(asa, v, asa->out + asa->out_len);
   asa->num_out++;
+  ASA_COUNT(asa, N_SPECTRUMS, 1);
+  if (++asa->out_num == asa->param.join) asa_flush(asa);
+}
+
+
+int asa_process(asa_t asa) {
+  const int k = asa->param.k, spectra = asa_spectra(&asa->param);
+  int j, result = 1;
+  while (result > 0) {
+    for (j = 0; j < k; j++) {
+      uint64_t t0 = ASA_CLOCK(asa);
+      result = asa_read(asa);
+      ASA_TIME(asa, T_READ, t0);
+      if (result < 1) break;
+
+      t0 = ASA_CLOCK(asa);
+      for (int chan = 0; chan < spectra; chan++) {
+        asa_batch_slot(asa, j * spectra + chan);
+        asa->chan = asa->param.mix ? -1 : chan;
+        asa_pad_and_window(asa);
+      }
+      ASA_TIME(asa, T_WINDOW, t0);
+    }
+    if (!j) break;
+
+    uint64_t t0 = ASA_CLOCK(asa);
+    asa_run_fft(asa); // the whole batch, even if the last one is short
+    ASA_TIME(asa, T_FFT, t0);
+
+    for (int i = 0; i < j * spectra; i++) {
+      asa_batch_slot(asa, i);
+      asa->chan = i % spectra;
+      t0 = ASA_CLOCK(asa);
+      asa_lines(asa);
+      ASA_TIME(asa, T_LINES, t0);
+      t0 = ASA_CLOCK(asa);
+      if (asa_average(asa)) asa_write(asa);
+      ASA_TIME(asa, T_WRITE, t0);
+    }
+  }
+  asa_flush(asa); // at the end or until there is input again
+  return result;
 }
 
 
 void asa_cleanup(asa_t asa) {
-  if (asa->d) fftw_free(asa->d);
-  if (asa->c) fftw_free(asa->c);
-  if (asa->plan) fftw_destroy_plan(asa->plan);
-  fftw_cleanup();
+  if (asa->w) FFTW(free)(asa->w);
+  if (asa->dk) FFTW(free)(asa->dk);
+  if (asa->ck) FFTW(free)(asa->ck);
+  if (asa->sum) free(asa->sum);
+  if (asa->rg) free(asa->rg);
+  if (asa->smooth) free(asa->smooth);
+  if (asa->out) free(asa->out);
+  if (asa->prev) free(asa->prev);
+  if (asa->shm) asa_free_shm(asa);
+#ifndef ASA_FIXED
+  if (asa->sdft) asa_free_sdft(asa);
+#endif
+  if (asa->fixed) asa_free_fixed(asa);
+  if (asa->band) asa_free_band(asa);
+  if (asa->decim) asa_free_decim(asa);
+  if (asa->cq) asa_free_cq(asa);
+  if (asa->stats) free(asa->stats);
+  if (asa->ring)
+    munmap(asa->ring, asa->in_map ? asa->ring_size : 2 * asa->ring_size);
+#ifndef ASA_FIXED
+  if (asa->plan && !asa->plan_shared) FFTW(destroy_plan)(asa->plan);
+#endif
 
   asa = (asa_t){ 0 };
 }
@@ -1,7 +1,40 @@
 #ifndef ASA_H
 #define ASA_H
 
+#include <stdint.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <time.h>
+
+
+// Single precision with fftwf if compiled with -DASA_FLOAT (make FLOAT=1)
+#ifdef ASA_FLOAT
+typedef float asa_real_t;
+#else
+typedef double asa_real_t;
+#endif
+
+// make FIXED=1 builds without fftw: only the fixed-point and the goertzel
+// engine, the buffers have the types of fftw and are allocated by malloc()
+#ifdef ASA_FIXED
+typedef asa_real_t asa_nofftw_complex[2];
+typedef void *asa_nofftw_plan;
+#define FFTW(name) asa_nofftw_ ## name
+static inline asa_real_t *asa_nofftw_alloc_real(size_t n) {
+  return malloc(sizeof(asa_real_t) * n);
+}
+static inline asa_nofftw_complex *asa_nofftw_alloc_complex(size_t n) {
+  return malloc(sizeof(asa_nofftw_complex) * n);
+}
+static inline void asa_nofftw_free(void *p) { free(p); }
+#else
 #include <fftw3.h>
+#ifdef ASA_FLOAT
+#define FFTW(name) fftwf_ ## name
+#else
+#define FFTW(name) fftw_ ## name
+#endif
+#endif
 
 
 #define W_BOXCAR         0
@@ -13,6 +46,111 @@
 
 extern const char* window_names[];
 
+// Coefficients a0 to a4 of the windows as cosine sums
+extern const double window_cosines[W_LAST + 1][5];
+
+#define E_ESTIMATE       0
+#define E_MEASURE        1
+#define E_PATIENT        2
+#define E_EXHAUSTIVE     3
+#define E_FIRST          E_ESTIMATE
+#define E_LAST           E_EXHAUSTIVE
+
+extern const char* effort_names[];
+
+#define X_FFT            0
+#define X_SDFT           1
+#define X_FIXED          2
+#define X_GOERTZEL       3
+#define X_PRUNED         4
+#define X_PADDED         5
+#define X_AUTO           6
+#define X_FIRST          X_FFT
+#define X_LAST           X_AUTO
+
+extern const char* engine_names[];
+
+// make FIXED=1 makes the fixed-point engine the default
+#ifdef ASA_FIXED
+#define ASA_ENGINE       X_FIXED
+#define ASA_ENGINE_NAME  "fixed"
+#else
+#define ASA_ENGINE       X_AUTO
+#define ASA_ENGINE_NAME  "auto"
+#endif
+
+// Output formats (-o): u8 is raw l bytes per spectrum as ever, the others
+// start with a header of ASA_HEADER_SIZE bytes, little endian:
+//   "ASPN", version, format, spectrums per sequence (channels), 0,
+//   l (u16), floor of db in dB (s16, else 0), input frames per spectrum
+//   d r decim (u32)
+// then per spectrum: db l bytes (floor dB to 0 dB), u16 l words, f32 l
+// floats (0 to 1), or delta: a key byte (1: the lines before are 0, every
+// ASA_KEY_FRAMES spectrums of a channel, else 0: the last spectrum of the
+// channel) then tokens until all l lines are there: 0 to 127 skip 1 to 128
+// unchanged lines, 128 to 255 are followed by 1 to 128 new u8 lines
+#define O_U8             0
+#define O_DB             1
+#define O_U16            2
+#define O_F32            3
+#define O_DELTA          4
+#define O_FIRST          O_U8
+#define O_LAST           O_DELTA
+
+#define ASA_HEADER_SIZE    16
+#define ASA_HEADER_VERSION 1
+#define ASA_HEADER_MAX_L   65535 // l is a u16 in the header
+#define ASA_KEY_FRAMES     64
+
+extern const char* format_names[];
+
+// Shared memory output (-M, see asa_shm.c): this header, then at ASA_SHM_DATA
+// the slots, slot num % slots has frame num: the encoded spectrums of all
+// channels of a sequence. Little endian like the header of the formats.
+#define ASA_SHM_DATA     64
+
+typedef struct asa_shm_t {
+  char magic[4];          // "ASPM" once the header is complete
+  uint8_t version;        // ASA_HEADER_VERSION
+  uint8_t format;         // output format, not O_DELTA
+  uint8_t spectra;        // spectrums per frame (channels)
+  uint8_t pad;
+  uint16_t l;             // lines of a spectrum, ASA_HEADER_MAX_L at most
+  int16_t floor;          // of the db format in dB, else 0
+  uint32_t hop;           // input frames per spectrum d r decim
+  uint32_t frame;         // bytes of a frame
+  uint32_t slot_size;     // bytes of a slot, multiple of 64
+  uint32_t slots;         // number of slots
+  _Atomic uint64_t head;  // number of frames published
+} asa_shm_t;
+
+typedef struct asa_shm_slot_t {
+  _Atomic uint64_t seq;   // 2 (num + 1) when frame num is in data, odd while
+  uint8_t data[];         // it is written
+} asa_shm_slot_t;
+
+// Stages timed and counters of the stats (see asa_stats.c), make NOSTATS=1
+// compiles them out
+#define T_READ           0
+#define T_WINDOW         1
+#define T_FFT            2
+#define T_LINES          3
+#define T_WRITE          4
+#define T_STAGES         5
+
+extern const char* stage_names[];
+
+#define N_SEQUENCES      0
+#define N_SPECTRUMS      1
+#define N_SHORT_READS    2 // read() returned less than missing for a sequence
+#define N_SKIPPED        3 // bytes of input between sequences (d > s)
+#define N_STALE          4 // bytes of input dropped by live mode
+#define N_DROPPED        5 // spectrums not written by live mode
+#define N_WRITES         6 // write() calls of spectrums (see -j)
+#define N_COUNTERS       7
+
+extern const char* counter_names[];
+
 extern const int x;
 
 #define C_SIZE 1000
@@ -26,10 +164,32 @@ typedef struct asa_param_t { //                          limits
   int b;         // number of bins in fft output         b = b1 - b0
   double p;      // distribution matching to power       1 <= p <= 2
   int l;         // number of lines in analyser output   1 <= l <= b
-  int *g;        // distribution of bins to lines g[l]
+  int *g;        // distribution of bins to lines g[l] (not with q)
   int r;         // number of sequences per spectrum     1 <= r <= x
   int d;         // distance between sequence starts     1 <= d <= x
   int w;         // window function
+  int e;         // fftw planning effort
+  char *wisdom;  // fftw wisdom file or NULL
+  int chunk;     // size of reads from input in bytes    1 <= chunk <= x
+  int t;         // number of fft worker threads         1 <= t <= 64
+  int k;         // number of sequences per fft batch    1 <= k <= 256
+  int c;         // number of interleaved channels       1 <= c <= 16
+  int mix;       // mix the channels into one spectrum
+  int engine;    // spectrum engine, one of X_* (see engine_names)
+  int live;      // drop stale input and spectrums the output isn't ready for
+  int q;         // constant-Q lines instead of distributing bins with g
+  double smooth; // weight of new lines in the smoothing  0 < smooth <= 1
+  double gravity; // fall speed gain per spectrum         0 <= gravity <= 1
+  int hold;      // spectrums a peak is held              0 <= hold <= 9999
+  int gain;      // spectrums the auto-gain halves in,    0 <= gain <= 99999
+                 // 0: every spectrum scaled to its maximum
+  int format;    // output format, see O_U8
+  double floor;  // dB of 0 in the db format               -999 <= floor < 0
+  int join;      // spectrums written with one write()    1 <= join <= 256
+  char *shm;     // name of the shared memory output or NULL
+  int slots;     // frames in the shared memory ring       2 <= slots <= 4096
+  int rate;      // sampling frequency of the input in Hz  1 <= rate <= 768000
+  int decim;     // decimation factor of the input, 0: 1   1 <= decim <= 64
 } asa_param_t;
 
 
@@ -39,30 +199,223 @@ typedef struct asa_struct_t {
   int fd_out;             // file descriptor of output (u8 spectrum data)
   int num_in;             // how many sequences of s s16le samples read 
   int num_out;            // how many spectrums of b u8 magnitudes written
-  int16_t *s16le;         // buffer for a sequence of s s16le samples
-  double *d;              // input for fft, then bins, then lines
-  double max_mag;         // maximum magnitude after asa_spectrum()
-  fftw_complex *c;        // output of fft
-  fftw_plan plan;         // fftw3 plan
+  int in_file;            // fd_in is a regular file (seekable)
+  int in_map;             // ring is the whole input file mapped (no reads)
+  char *ring;             // input ring buffer, mapped twice back to back
+  size_t ring_size;       // size of the ring in bytes (multiple of page size)
+  size_t head;            // offset of the current sequence in the ring
+  size_t avail;           // bytes read into the ring from head on
+  size_t skip;            // bytes of input to skip before the next sequence
+  int16_t *s16le;         // current sequence of s s16le frames in the ring
+                          // (decimated: of asa_decimate())
+  struct asa_decim_t *decim; // decimation front end or NULL (asa_decim.c)
+  int gap;                // live mode dropped input before this sequence
+  int drop;               // live mode drops the spectrums of this sequence
+  int chan;               // channel of s16le to window, -1 mixes all
+  asa_real_t *w;          // window coefficients for the s samples
+  asa_real_t *d;          // input for fft, then bins, then lines (batch slot)
+  asa_real_t max_mag;     // maximum magnitude after asa_spectrum()
+  asa_real_t *sum;        // sum of lines for averaging over r sequences
+  int num_sum;            // how many sequences of lines are in sum
+  asa_real_t *smooth;     // state of asa_scale(), l per channel: smoothed,
+  asa_real_t *level;      // displayed (peaks held, falling with gravity),
+  asa_real_t *fall;       // how far a line falls next,
+  asa_real_t *hold;       // spectrums the peak is still held, and
+  asa_real_t *gain;       // the reference magnitude of every channel
+  uint8_t *out;           // encoded spectrums not written yet (out_size
+  size_t out_size;        // bytes for join of them), and
+  size_t out_len;         // their size in bytes and
+  int out_num;            // their number
+  uint8_t *prev;          // last u8 lines written per channel (delta format)
+  asa_shm_t *shm;         // shared memory output or NULL (in asa_shm.c)
+  size_t shm_size;        // size of its mapping
+  FFTW(complex) *c;       // output of fft (batch slot)
+  asa_real_t *dk;         // k fft inputs of n reals for a batch
+  asa_real_t *rg;         // reciprocals of g[l] for combining bins to lines
+  void (*mag)(asa_real_t *d, const FFTW(complex) *c, int b); // magnitudes
+  FFTW(complex) *ck;      // k fft outputs of m bins for a batch
+  FFTW(plan) plan;        // fftw3 plan
+  int plan_shared;        // plan is another asa's, don't destroy it
+  struct asa_sdft_t *sdft; // state of the sliding dft engine (in asa_sdft.c)
+  struct asa_fixed_t *fixed; // state of the fixed-point engine (asa_fixed.c)
+  struct asa_band_t *band; // state of the goertzel or pruned fft engines
+  int dirty;              // d[0:dirty) of the batch slots may be nonzero
+  struct asa_stats_t *stats; // timings and counters or NULL (in asa_stats.c)
+  struct asa_cq_t *cq;    // kernels of the constant-Q lines (in asa_cq.c)
 } *asa_t;
 
+// Check the parameters, NULL if fine, else what's wrong (in the words of the
+// options of auspan)
+extern const char *asa_check_param(const asa_param_t *p);
+
 extern int* asa_distribute_bins(int l, int b, double p);
 
+// Calculate the window coefficients once (called by asa_init_fft())
+extern void asa_init_window(asa_t asa);
+
+// Window, buffers and plan; a plan set before is shared (see plan_shared)
 extern void asa_init_fft(asa_t asa);
 
+// Map the input file or a ring buffer for the input (fd_in must be set)
+extern void asa_init_input(asa_t asa);
+
+// Read the next sequence: 1 if read, 0 at end of file, -1 if non-blocking
+// input would block (call again when there is input). In live mode all input
+// there is gets read and the newest sequence is taken, see asa_drain()
 extern int asa_read(asa_t asa);
 
 extern void asa_pad_and_window(asa_t asa);
 
+// Point d and c to the j-th fft of the batch, channel j % spectra of
+// sequence j / spectra, see asa_spectra() and asa_batch()
+extern void asa_batch_slot(asa_t asa, int j);
+
+// Run the ffts of the whole batch (asa_batch() ffts)
 extern void asa_run_fft(asa_t asa);
 
+// Choose the magnitude kernel for the cpu (called by asa_init_fft())
+extern void asa_init_lines(asa_t asa);
+
 // Get bins from the complex fft result then combine bins to lines
 extern void asa_lines(asa_t asa);
 
+// Average lines of channel chan over r sequences, return 1 if a spectrum is
+// ready to write
+extern int asa_average(asa_t asa);
+
+// Smoothing, gravity, peak hold and auto-gain state, if any of them is on
+// (called by asa_init_fft())
+extern void asa_init_scale(asa_t asa);
+
+// Scale the lines of channel chan to v with the state of asa_init_scale(),
+// 0 to 255 full scale (u8 without rounding)
+extern void asa_scale(asa_t asa, asa_real_t *v);
+
+// Buffer for join spectrums of the format, writes the header (fd_out must be
+// set)
+extern void asa_init_output(asa_t asa);
+
+// Scale, encode and buffer a spectrum, written when there are join of them
 extern void asa_write(asa_t asa);
 
+// Write the buffered spectrums (publish them to the shared memory)
+extern void asa_flush(asa_t asa);
+
+// Read, transform and write in batches of k sequences until asa_read() returns
+// 0 or -1, which is returned
+extern int asa_process(asa_t asa);
+
+// Sliding dft engine (in asa_sdft.c, not with make FIXED=1): asa_init_fft()
+// calls asa_init_sdft(), then asa_pad_and_window() slides the bins of the
+// channel by the new samples and asa_run_fft() only runs the fft to resync
+// the bins now and then
+extern void asa_init_sdft(asa_t asa);
+extern void asa_sdft_window(asa_t asa);
+extern void asa_sdft_run(asa_t asa);
+extern void asa_free_sdft(asa_t asa);
+
+// Fixed-point engine (in asa_fixed.c): asa_init_fft() calls asa_init_fixed()
+// instead of planning, asa_pad_and_window(), asa_run_fft() and asa_lines()
+// call asa_fixed_window(), asa_fixed_run() and asa_fixed_lines() on integer
+// points of its own; only the lines are asa_real_t
+extern void asa_init_fixed(asa_t asa);
+extern void asa_fixed_window(asa_t asa);
+extern void asa_fixed_run(asa_t asa);
+extern void asa_fixed_lines(asa_t asa);
+extern void asa_free_fixed(asa_t asa);
+
+// Engines for a narrow band of bins or a large zero padding (in asa_band.c):
+// asa_init_fft() resolves -e auto with asa_band_engine() by a cost model to
+// fft, goertzel, pruned or padded and calls asa_init_band() for the others
+// than fft instead of planning the fft, asa_run_fft() calls asa_band_run()
+// for the bins b0 to b1 of the batch. make FIXED=1 has goertzel only.
+extern int asa_band_engine(const asa_param_t *p);
+extern void asa_init_band(asa_t asa);
+extern void asa_band_run(asa_t asa);
+extern void asa_free_band(asa_t asa);
+
+// Constant-Q lines (in asa_cq.c): asa_init_lines() calls asa_init_cq() for
+// the sparse kernels of the lines, asa_lines() calls asa_cq_lines() to apply
+// them to the bins b0 to b1 instead of combining magnitudes
+extern void asa_init_cq(asa_t asa);
+extern void asa_cq_lines(asa_t asa);
+extern void asa_free_cq(asa_t asa);
+
+// Decimation front end (in asa_decim.c): with decim > 1 asa_init_input()
+// calls asa_init_decim(), asa_read() reads sequences of asa_in_frames() input
+// frames at a distance of d decim frames and asa_decimate() points s16le to
+// the s decimated frames of the sequence
+extern int asa_in_frames(const asa_param_t *p);
+extern void asa_init_decim(asa_t asa);
+extern void asa_decimate(asa_t asa);
+extern void asa_free_decim(asa_t asa);
+
+// Shared memory output (in asa_shm.c): asa_init_output() calls
+// asa_init_shm() instead of writing a header, asa_flush() publishes the frame
+// of the spectrums of every sequence with asa_shm_publish(). A consumer maps
+// the object read-only and takes frame num with asa_shm_read(): 1 if copied
+// to frame, 0 if not published yet, -1 if it was overwritten (the reader was
+// too slow), the latest frame is head - 1.
+extern void asa_init_shm(asa_t asa);
+extern void asa_shm_publish(asa_t asa);
+extern int asa_shm_read(const asa_shm_t *shm, uint64_t num, uint8_t *frame);
+extern void asa_free_shm(asa_t asa);
+
+// Stats (in asa_stats.c): histograms of the stage timings and counters of
+// asa, dumped to stderr on SIGUSR1 and to clients of the unix socket at path
+// (or NULL) by a thread started by asa_start_stats()
+extern void asa_init_stats(asa_t asa);
+extern void asa_start_stats(asa_t asas, int num, char *path);
+extern void asa_stop_stats(void);
+extern void asa_stats_time(struct asa_stats_t *stats, int stage, uint64_t ns);
+extern void asa_stats_add(struct asa_stats_t *stats, int counter, uint64_t n);
+
+static inline uint64_t asa_clock(void) {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1000000000ull + t.tv_nsec;
+}
+
+// t0 = ASA_CLOCK(asa) before a stage, ASA_TIME(asa, stage, t0) after it
+#ifdef ASA_NO_STATS
+#define ASA_CLOCK(asa) ((uint64_t)0)
+#define ASA_TIME(asa, stage, t0) ((void)(t0))
+#define ASA_COUNT(asa, counter, n) ((void)0)
+#else
+#define ASA_CLOCK(asa) ((asa)->stats ? asa_clock() : 0)
+#define ASA_TIME(asa, stage, t0) ((asa)->stats \
+  ? asa_stats_time((asa)->stats, stage, asa_clock() - (t0)) : (void)0)
+#define ASA_COUNT(asa, counter, n) ((asa)->stats \
+  ? asa_stats_add((asa)->stats, counter, n) : (void)0)
+#endif
+
+// Pipelined loop with reader thread, t fft workers and ordered writer thread
+// (in asa_thread.c)
+extern void asa_run_threads(asa_t asa, int t);
+
+// Process num streams with non-blocking inputs in one process until all of
+// them end, with t worker threads polling with epoll (in asa_server.c)
+extern void asa_run_server(asa_t streams, int num, int t);
+
+// Free everything of asa; fftw_cleanup() is left to the caller
 extern void asa_cleanup(asa_t asa);
 
+// Number of spectrums per sequence: one per channel unless mixed
+static inline int asa_spectra(const asa_param_t *p) {
+  return p->c > 1 && !p->mix ? p->c : 1;
+}
+
+// Number of ffts in a plan: k sequences with their spectrums, but workers of
+// the pipeline transform one sequence or one channel of it at a time
+static inline int asa_batch(const asa_param_t *p) {
+  return p->t > 1 ? 1 : p->k * asa_spectra(p);
+}
+
+// Input frames per decimated frame: decim, 1 without decimation (0 or 1)
+static inline int asa_decim(const asa_param_t *p) {
+  return p->decim > 1 ? p->decim : 1;
+}
+
 static inline int sum(int *g, int l) {
   int result = 0;
   for (int i = 0; i < l; i++) result += g[i];
@@ -75,6 +428,12 @@ static inline int sum(int *g, int l) {
   _a < _b ? _a : _b; \
 })
 
+#define max(a, b) ({ \
+  __typeof__ (a) _a = (a); \
+  __typeof__ (b) _b = (b); \
+  _a > _b ? _a : _b; \
+})
+
 
 
 
@@ -0,0 +1,323 @@
+#include <stdlib.h>
+#include <string.h>
+#include <tgmath.h>
+#include "asa.h"
+#include "y_dbg.h"
+
+
+// Engines for a band of bins b0 to b1 much narrower than the m bins of the
+// fft or a zero padding much larger than the samples, behind asa_run_fft():
+// it puts the bins b0 to b1 of every batch slot to c, the others are left as
+// they are (asa_lines() doesn't read them).
+//
+// Goertzel: a second order filter per bin over the s windowed samples (the
+// zero padding is skipped), O(b s) instead of O(n log n):
+//   s_t = x_t + 2 cos(w) s_t-1 - s_t-2
+//   X[k] = e^(-j w (i0 + s - 1)) (s_s-1 - e^(-j w) s_s-2),  w = 2 pi k / n
+// with i0 the first sample after the padding. The filters run in double
+// precision, also in the float build; four bins at a time, they are
+// independent.
+//
+// Pruned fft: the n samples are P subsequences x[q P + p] of Q = n / P
+// samples; one fftw plan does their P real ffts and the bins of the band are
+// combined from them, decimation in time:
+//   X[k] = sum_p e^(-2 pi j p k / n) S_p[k mod Q]
+// with S_p[Q - r] = S_p[r]* for the upper half. That is O(n log Q + b P)
+// instead of O(n log n).
+//
+// Padded fft, for n >= 2 s: the zero padding is pruned from the input. With
+// the s samples moved to the front (the phase e^(-2 pi j k i0 / n) makes up
+// for it) and k = P u + r, L = n / P >= s:
+//   X[P u + r] = sum_t<s (x[t] e^(-2 pi j t r / n)) e^(-2 pi j t u / L)
+// so the bins with k mod P = r are the complex fft of L points of the
+// twiddled samples, whose zeros from s to L are never written again. A real
+// input needs r <= P / 2 only, X[P u + r] = X[P (L - u - 1) + P - r]*. That
+// is O(n log L) instead of O(n log n): all n / 2 bins still cost O(n).
+//
+// -e auto picks the cheapest of the fft, the pruned fft with the best P,
+// goertzel and the padded fft by the cost model below: rough cycles of a core
+// with SIMD. fftw is tuned better than any of this, so the others have to be
+// cheaper by a margin.
+
+#define COST_FFT      0.5  // per n log2 n of the real fft
+#define COST_GOERTZEL 1.0  // per bin and sample
+#define COST_MAC      2.0  // per bin and subsequence of the pruned fft
+#define COST_CALL     20   // per fft or bin, the overhead
+#define COST_MARGIN   0.9  // the others are chosen below 0.9 times the fft
+
+#define MAX_P         256
+
+typedef struct asa_band_t {
+  int engine;         // X_GOERTZEL, X_PRUNED or X_PADDED
+  int P, Q;           // pruned: P subsequences of Q samples
+  FFTW(plan) plan;    // pruned: the P real ffts of a batch slot
+  FFTW(complex) *sub; // pruned: their Q / 2 + 1 bins each
+  asa_real_t (*tw)[2]; // pruned: e^(-2 pi j p k / n) of the P per bin;
+                      // padded: e^(-2 pi j t / n) for t < n
+  double *coeff;      // goertzel: 2 cos(w) per bin
+  double (*g)[4];     // goertzel: cos(w), sin(w), e^(-j w (i0 + s - 1))
+  int R, L;           // padded: R = P / 2 + 1 complex ffts of L points
+  FFTW(complex) *y;   // padded: the twiddled samples, zero from s to L
+  FFTW(complex) *z;   // padded: their ffts
+} asa_band_t;
+
+
+#ifndef ASA_FIXED // the fft, the pruned and the padded fft need fftw
+static double asa_cost_fft(const asa_param_t *p) {
+  return COST_FFT * p->n * log2(p->n) + COST_CALL;
+}
+
+static double asa_cost_goertzel(const asa_param_t *p) {
+  return (COST_GOERTZEL * p->s + COST_CALL) * p->b;
+}
+
+static double asa_cost_pruned(const asa_param_t *p, int P) {
+  return COST_FFT * p->n * log2(p->n / P) + COST_CALL * P + COST_MAC * p->b * P;
+}
+
+// The cheapest number of subsequences, a power of 2 with Q >= 8, 0 if none
+static int asa_best_p(const asa_param_t *p) {
+  int best = 0;
+  for (int P = 2; P <= MAX_P && p->n % P == 0 && p->n / P >= 8; P *= 2)
+    if (!best || asa_cost_pruned(p, P) < asa_cost_pruned(p, best)) best = P;
+  return best;
+}
+
+// A complex fft costs about two real ones
+static double asa_cost_padded(const asa_param_t *p, int P) {
+  const int L = p->n / P, R = P / 2 + 1;
+  return R * (2 * COST_FFT * L * log2(L) + COST_CALL + COST_MAC / 2 * p->s)
+    + COST_MAC * p->b;
+}
+
+// The largest power of 2 with L = n / P >= s, 0 if none
+static int asa_padded_p(const asa_param_t *p) {
+  int P = 1;
+  while (p->n % (2 * P) == 0 && p->n / (2 * P) >= p->s) P *= 2;
+  return P > 1 ? P : 0;
+}
+
+
+int asa_band_engine(const asa_param_t *p) {
+  const double fft = asa_cost_fft(p), goertzel = asa_cost_goertzel(p);
+  const int P = p->t > 1 ? 0 : asa_best_p(p); // pruned isn't for workers
+  const double pruned = P ? asa_cost_pruned(p, P) : INFINITY;
+  const int P2 = p->t > 1 ? 0 : asa_padded_p(p);
+  const double padded = P2 ? asa_cost_padded(p, P2) : INFINITY;
+
+  int engine = X_FFT;
+  double cost = COST_MARGIN * fft;
+  if (goertzel < cost) engine = X_GOERTZEL, cost = goertzel;
+  if (pruned < cost) engine = X_PRUNED, cost = pruned;
+  if (padded < cost) engine = X_PADDED, cost = padded;
+  y_dbg("costs: fft %.0f, goertzel %.0f, pruned fft %.0f (P %d), padded fft "
+    "%.0f (P %d)", fft, goertzel, pruned, P, padded, P2);
+  y_info("-e auto: %s engine for bins %d to %d of %d", engine_names[engine],
+    p->b0, p->b1, p->m);
+  return engine;
+}
+
+
+static void asa_init_pruned(asa_t asa, asa_band_t *bd) {
+  const asa_param_t *const p = &asa->param;
+  const int P = bd->P = asa_best_p(p), Q = bd->Q = p->n / P, h = Q / 2 + 1;
+  y_assert(P >= 2 && p->t == 1);
+
+  bd->sub = FFTW(alloc_complex)(P * h);
+  bd->tw = malloc(sizeof(*bd->tw) * p->b * P);
+  if (!bd->sub || !bd->tw) y_oom();
+  for (int i = 0; i < p->b; i++) {
+    for (int j = 0; j < P; j++) {
+      // p k mod n keeps the phase exact for large n
+      const double phi = 2 * M_PI * ((long)j * (p->b0 + i) % p->n) / p->n;
+      bd->tw[i * P + j][0] = cos(phi);
+      bd->tw[i * P + j][1] = -sin(phi);
+    }
+  }
+
+  static const unsigned flags[] = {
+    FFTW_ESTIMATE, FFTW_MEASURE, FFTW_PATIENT, FFTW_EXHAUSTIVE
+  };
+  bd->plan = FFTW(plan_many_dft_r2c)(1, &bd->Q, P,
+    asa->dk, NULL, P, 1, bd->sub, NULL, 1, h, flags[p->e]);
+  if (!bd->plan) y_error("fftw plan failed");
+  y_dbg("pruned fft: %d ffts of %d samples for %d bins", P, Q, p->b);
+}
+#endif
+
+
+static void asa_init_goertzel(asa_t asa, asa_band_t *bd) {
+  const asa_param_t *const p = &asa->param;
+  const int last = (p->n - p->s) / 2 + p->s - 1; // of the samples
+
+  bd->coeff = malloc(sizeof(*bd->coeff) * p->b);
+  bd->g = malloc(sizeof(*bd->g) * p->b);
+  if (!bd->coeff || !bd->g) y_oom();
+  for (int i = 0; i < p->b; i++) {
+    const double w = 2 * M_PI * (p->b0 + i) / p->n;
+    const double phi = 2 * M_PI * ((long)(p->b0 + i) * last % p->n) / p->n;
+    bd->coeff[i] = 2 * cos(w);
+    bd->g[i][0] = cos(w);
+    bd->g[i][1] = sin(w);
+    bd->g[i][2] = cos(phi);
+    bd->g[i][3] = -sin(phi);
+  }
+  y_dbg("goertzel filters for %d bins over %d samples", p->b, p->s);
+}
+
+
+#ifndef ASA_FIXED
+static void asa_init_padded(asa_t asa, asa_band_t *bd) {
+  const asa_param_t *const p = &asa->param;
+  const int n = p->n, P = bd->P = asa_padded_p(p);
+  const int L = bd->L = n / P, R = bd->R = P / 2 + 1;
+  y_assert(P >= 2 && p->t == 1);
+
+  bd->y = FFTW(alloc_complex)(R * L);
+  bd->z = FFTW(alloc_complex)(R * L);
+  bd->tw = malloc(sizeof(*bd->tw) * n);
+  if (!bd->y || !bd->z || !bd->tw) y_oom();
+  for (int t = 0; t < n; t++) {
+    bd->tw[t][0] = cos(2 * M_PI * t / n);
+    bd->tw[t][1] = -sin(2 * M_PI * t / n);
+  }
+
+  static const unsigned flags[] = {
+    FFTW_ESTIMATE, FFTW_MEASURE, FFTW_PATIENT, FFTW_EXHAUSTIVE
+  };
+  bd->plan = FFTW(plan_many_dft)(1, &bd->L, R, bd->y, NULL, 1, L,
+    bd->z, NULL, 1, L, FFTW_FORWARD, flags[p->e]);
+  if (!bd->plan) y_error("fftw plan failed");
+  memset(bd->y, 0, sizeof(*bd->y) * R * L); // after planning
+  y_dbg("padded fft: %d ffts of %d points for %d samples", R, L, p->s);
+}
+#endif
+
+
+void asa_init_band(asa_t asa) {
+  asa_band_t *bd = calloc(1, sizeof(*bd));
+  if (!bd) y_oom();
+  bd->engine = asa->param.engine;
+  if (bd->engine == X_GOERTZEL) asa_init_goertzel(asa, bd);
+#ifndef ASA_FIXED
+  else if (bd->engine == X_PRUNED) asa_init_pruned(asa, bd);
+  else asa_init_padded(asa, bd);
+#endif
+  asa->band = bd;
+}
+
+
+// Bins i to i + width of the band from the s samples x
+static inline void asa_goertzel(const asa_band_t *bd, int i, int width,
+    const asa_real_t *x, int s, FFTW(complex) *c) {
+  double s1[4] = { 0 }, s2[4] = { 0 };
+  const double *const coeff = bd->coeff + i;
+  for (int t = 0; t < s; t++) {
+    for (int u = 0; u < width; u++) {
+      const double s0 = x[t] + coeff[u] * s1[u] - s2[u];
+      s2[u] = s1[u];
+      s1[u] = s0;
+    }
+  }
+  for (int u = 0; u < width; u++) {
+    const double *const g = bd->g[i + u];
+    const double re = s1[u] - g[0] * s2[u], im = g[1] * s2[u];
+    c[i + u][0] = re * g[2] - im * g[3];
+    c[i + u][1] = re * g[3] + im * g[2];
+  }
+}
+
+
+// Combine the bins of the band from the ffts of the subsequences
+#ifndef ASA_FIXED
+static void asa_pruned(const asa_band_t *bd, const asa_param_t *p,
+    FFTW(complex) *c) {
+  const int P = bd->P, Q = bd->Q, h = Q / 2 + 1;
+  for (int i = 0; i < p->b; i++) {
+    const int r = (p->b0 + i) % Q, upper = r >= h;
+    const FFTW(complex) *const S = bd->sub + (upper ? Q - r : r);
+    const asa_real_t (*const tw)[2] = bd->tw + i * P;
+    double re = 0, im = 0;
+    for (int j = 0; j < P; j++) {
+      const double sr = S[j * h][0], si = upper ? -S[j * h][1] : S[j * h][1];
+      re += tw[j][0] * sr - tw[j][1] * si;
+      im += tw[j][0] * si + tw[j][1] * sr;
+    }
+    c[i][0] = re;
+    c[i][1] = im;
+  }
+}
+
+
+// Twiddle the samples x for the R ffts, then take the bins of the band from
+// them with the phase of the first sample i0
+static void asa_padded(const asa_band_t *bd, const asa_param_t *p,
+    const asa_real_t *x, FFTW(complex) *c) {
+  const int n = p->n, s = p->s, P = bd->P, L = bd->L, R = bd->R;
+  const int i0 = (n - s) / 2;
+  const asa_real_t (*const tw)[2] = bd->tw;
+
+  for (int r = 0; r < R; r++) {
+    FFTW(complex) *const y = bd->y + r * L;
+    for (int t = 0, i = 0; t < s; t++) {
+      y[t][0] = x[t] * tw[i][0];
+      y[t][1] = x[t] * tw[i][1];
+      if ((i += r) >= n) i -= n;
+    }
+  }
+  FFTW(execute_dft)(bd->plan, bd->y, bd->z);
+
+  for (int i = 0; i < p->b; i++) {
+    const int k = p->b0 + i, r = k % P, u = k / P, upper = r > P / 2;
+    const FFTW(complex) *const Z = upper
+      ? bd->z + (P - r) * L + L - u - 1 : bd->z + r * L + u;
+    const double zr = Z[0][0], zi = upper ? -Z[0][1] : Z[0][1];
+    const asa_real_t *const ph = tw[(long)k * i0 % n];
+    c[i][0] = zr * ph[0] - zi * ph[1];
+    c[i][1] = zr * ph[1] + zi * ph[0];
+  }
+}
+#endif
+
+
+void asa_band_run(asa_t asa) {
+  const asa_band_t *const bd = asa->band;
+  const asa_param_t *const p = &asa->param;
+  const int n = p->n, m = p->m, s = p->s, b = p->b;
+
+  for (int j = 0; j < asa_batch(p); j++) {
+    asa_real_t *const x = asa->dk + j * n;
+    FFTW(complex) *const c = asa->ck + j * m + p->b0;
+    const asa_real_t *const samples = x + (n - s) / 2;
+#ifndef ASA_FIXED
+    if (bd->engine == X_PRUNED) {
+      FFTW(execute_dft_r2c)(bd->plan, x, bd->sub);
+      asa_pruned(bd, p, c);
+      continue;
+    }
+    if (bd->engine == X_PADDED) {
+      asa_padded(bd, p, samples, c);
+      continue;
+    }
+#endif
+    int i = 0;
+    for (; i + 4 <= b; i += 4) asa_goertzel(bd, i, 4, samples, s, c);
+    for (; i < b; i++) asa_goertzel(bd, i, 1, samples, s, c);
+  }
+}
+
+
+void asa_free_band(asa_t asa) {
+  asa_band_t *const bd = asa->band;
+#ifndef ASA_FIXED
+  if (bd->plan) FFTW(destroy_plan)(bd->plan);
+#endif
+  if (bd->sub) FFTW(free)(bd->sub);
+  if (bd->y) FFTW(free)(bd->y);
+  if (bd->z) FFTW(free)(bd->z);
+  free(bd->tw);
+  free(bd->coeff);
+  free(bd->g);
+  free(bd);
+  asa->band = NULL;
+}
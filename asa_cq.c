@@ -0,0 +1,155 @@
+#include <stdlib.h>
+#include <complex.h>
+#include <tgmath.h>
+#include "asa.h"
+#include "y_dbg.h"
+
+
+// Constant-Q lines with spectral kernels (Brown and Puckette 1992).
+//
+// The l lines divide the bins b0 - 1/2 to b1 + 1/2 logarithmically, so every
+// line has the same ratio of center frequency to bandwidth, Q. Line k is the
+// sequence multiplied with a temporal kernel, the window (-w) over N_k samples
+// times e^(2 pi j f_k t / n) at its center frequency f_k (in bins). A line
+// needs Q periods of its frequency, so N_k = Q n / f_k, but at most s: the low
+// lines can't be sharper than the sequence is long.
+//
+// By Parseval the product with the kernel is (1 / n) sum_j X[j] K_k[j]* with
+// the dft X of the sequence and K_k of the kernel. The sequence is real, so
+// X[n - j] = X[j]* and the bins above n / 2 (negative frequencies) are taken
+// from the bins b0 to b1 too: they matter for the low lines, whose kernels
+// reach the image of their frequency below 0. K_k is concentrated around f_k
+// (and -f_k), so its small values are dropped and the kernels are stored as a
+// sparse matrix in CSR (compressed sparse rows): asa_lines() then costs one
+// complex multiply-add per stored value instead of an fft of size Q n / f_1.
+//
+// The window is in the kernels, so the fft (or the sliding dft) gets the
+// samples unwindowed (see asa_init_window()).
+
+#define CQ_THRESHOLD 0.01 // drop values below 1% of the maximum of the line
+
+typedef struct asa_cq_t {
+  int *row;               // values of line i are row[i] to row[i + 1] - 1,
+  int *image;             // of them image[i] to row[i + 1] - 1 for X[n - j]
+  int *bin;               // bin j of a value, relative to b0
+  FFTW(complex) *val;     // K[j]* / n, for the image K[n - j] / n
+} asa_cq_t;
+
+
+// Sum over t from 0 to N - 1 of e^(j theta t)
+static double complex asa_geometric(double theta, int N) {
+  if (fabs(remainder(theta, 2 * M_PI)) < 1e-12) return N;
+  return cexp(I * theta * (N - 1) / 2) * sin(N * theta / 2) / sin(theta / 2);
+}
+
+
+// K[j] of the kernel of N samples starting at t0 at frequency f (in bins), in
+// closed form: the window is a sum of cosines, so K[j] is a sum of geometric
+// series; the window is sampled at t + 1/2 so no sample of it is 0
+static double complex asa_kernel(const double *a, int n, int t0, int N,
+    double f, int j) {
+  const double phi = 2 * M_PI * (f - j) / n;
+  double complex k = a[0] * asa_geometric(phi, N);
+  for (int h = 1; h < 5 && a[h]; h++) {
+    const double psi = 2 * M_PI * h / N, c = h % 2 ? -a[h] / 2 : a[h] / 2;
+    k += c * (cexp(I * psi / 2) * asa_geometric(phi + psi, N)
+      + cexp(-I * psi / 2) * asa_geometric(phi - psi, N));
+  }
+  return cexp(I * phi * t0) * k;
+}
+
+
+void asa_init_cq(asa_t asa) {
+  const asa_param_t *const p = &asa->param;
+  const int n = p->n, s = p->s, l = p->l, b = p->b;
+  y_assert(p->b0 >= 1);
+
+  asa_cq_t *cq = calloc(1, sizeof(*cq));
+  if (!cq) y_oom();
+  cq->row = malloc(sizeof(*cq->row) * (l + 1));
+  cq->image = malloc(sizeof(*cq->image) * l);
+  double complex *k = malloc(sizeof(*k) * 2 * b); // and image k[b + j]
+  if (!cq->row || !cq->image || !k) y_oom();
+
+  const double e0 = p->b0 - 0.5, ratio = pow((p->b1 + 0.5) / e0, 1.0 / l);
+  const double Q = 1 / (sqrt(ratio) - 1 / sqrt(ratio));
+  const double *const a = window_cosines[p->w];
+
+  int num = 0, size = 0;
+  cq->row[0] = 0;
+  for (int i = 0; i < l; i++) {
+    // The kernel is centered in the sequence, which is centered in the n
+    // samples, and scaled so a sine at f gives the same line at every N
+    const double f = e0 * pow(ratio, i + 0.5);
+    const int N = min(s, max(1, (int)lround(Q * n / f)));
+    const int t0 = (n - N) / 2;
+    const double scale = (double)s / (N * a[0]) / n;
+
+    double top = 0;
+    for (int j = 0; j < b; j++) {
+      k[j] = asa_kernel(a, n, t0, N, f, p->b0 + j) * scale;
+      // the Nyquist bin n / 2 has no image
+      k[b + j] = 2 * (p->b0 + j) == n ? 0
+        : conj(asa_kernel(a, n, t0, N, f, n - p->b0 - j) * scale);
+      top = fmax(top, fmax(cabs(k[j]), cabs(k[b + j])));
+    }
+
+    for (int j = 0; j < 2 * b; j++) {
+      if (j == b) cq->image[i] = num;
+      if (cabs(k[j]) < CQ_THRESHOLD * top) continue;
+      if (num == size) {
+        size = size ? 2 * size : 4 * l;
+        cq->bin = realloc(cq->bin, sizeof(*cq->bin) * size);
+        cq->val = realloc(cq->val, sizeof(*cq->val) * size);
+        if (!cq->bin || !cq->val) y_oom();
+      }
+      cq->bin[num] = j % b;
+      cq->val[num][0] = creal(k[j]);
+      cq->val[num][1] = -cimag(k[j]);
+      num++;
+    }
+    cq->row[i + 1] = num;
+    y_trc("cq line %d: f %.3f N %d values %d (image %d)", i, f, N,
+      num - cq->row[i], num - cq->image[i]);
+  }
+  free(k);
+
+  y_dbg("constant-Q lines: Q %.2f, %d kernel values (%.1f per line)", Q,
+    num, (double)num / l);
+  asa->cq = cq;
+}
+
+
+void asa_cq_lines(asa_t asa) {
+  const asa_cq_t *const cq = asa->cq;
+  const FFTW(complex) *const c = asa->c + asa->param.b0;
+  asa_real_t *const d = asa->d;
+
+  // X[j] K[j]*, then for the image X[n - j] K[n - j]* = (X[j] K[n - j])*
+  for (int i = 0; i < asa->param.l; i++) {
+    asa_real_t re = 0, im = 0;
+    int v = cq->row[i];
+    for (; v < cq->image[i]; v++) {
+      const asa_real_t *const x = c[cq->bin[v]], *const k = cq->val[v];
+      re += x[0] * k[0] - x[1] * k[1];
+      im += x[0] * k[1] + x[1] * k[0];
+    }
+    for (; v < cq->row[i + 1]; v++) {
+      const asa_real_t *const x = c[cq->bin[v]], *const k = cq->val[v];
+      re += x[0] * k[0] - x[1] * k[1];
+      im -= x[0] * k[1] + x[1] * k[0];
+    }
+    d[i] = sqrt(re * re + im * im);
+  }
+}
+
+
+void asa_free_cq(asa_t asa) {
+  asa_cq_t *const cq = asa->cq;
+  free(cq->row);
+  free(cq->image);
+  free(cq->bin);
+  free(cq->val);
+  free(cq);
+  asa->cq = NULL;
+}
@@ -0,0 +1,104 @@
+#include <stdlib.h>
+#include <string.h>
+#include <tgmath.h>
+#include "asa.h"
+#include "y_dbg.h"
+
+
+// Decimation front end (-D): low-pass and keep every D-th frame, so an fft of
+// s decimated samples resolves like one of s D input samples below the new
+// Nyquist frequency f / 2 D.
+//
+// asa_read() reads sequences of (s - 1) D + T input frames at a distance of
+// d D frames and asa_decimate() turns them into the s frames of the sequence:
+//   y[m] = sum_i<T h[i] x[m D + i]
+// only the kept outputs are computed (polyphase). h is a windowed sinc, T =
+// 16 D + 1 taps, Blackman window (about -74 dB stopband), -6 dB at 0.8 of the
+// new Nyquist frequency, DC gain 1. With overlap (d < s) the next sequence
+// has the last s - d frames of this one, so only the d new frames are
+// filtered; the frames are kept in 2 s frames and moved to the front every
+// s / d sequences. The decimated samples are rounded to s16 again.
+
+#define DECIM_ZEROS   8   // zero crossings of the sinc on each side
+#define DECIM_CUTOFF  0.8 // -6 dB at 0.8 of the new Nyquist frequency
+
+typedef struct asa_decim_t {
+  int D, T;           // factor and taps
+  asa_real_t *h;      // low-pass of T taps
+  int16_t *y;         // 2 s decimated frames, the sequence starts at frame pos
+  int pos;
+  int valid;          // the sequence at pos is the previous one
+} asa_decim_t;
+
+
+int asa_in_frames(const asa_param_t *p) {
+  const int D = asa_decim(p);
+  return D == 1 ? p->s : (p->s - 1) * D + 2 * DECIM_ZEROS * D + 1;
+}
+
+
+void asa_init_decim(asa_t asa) {
+  const asa_param_t *const p = &asa->param;
+  asa_decim_t *dc = calloc(1, sizeof(*dc));
+  if (!dc) y_oom();
+  const int D = dc->D = asa_decim(p), T = dc->T = 2 * DECIM_ZEROS * D + 1;
+
+  dc->h = malloc(sizeof(*dc->h) * T);
+  dc->y = malloc(sizeof(*dc->y) * 2 * p->s * p->c);
+  if (!dc->h || !dc->y) y_oom();
+
+  const double fc = DECIM_CUTOFF / (2 * D); // cycles per input frame
+  double sum = 0, h[T];
+  for (int i = 0; i < T; i++) {
+    const double t = i - (T - 1) / 2.0, a = 2 * M_PI * i / (T - 1);
+    const double sinc = t == 0 ? 2 * fc : sin(2 * M_PI * fc * t) / (M_PI * t);
+    sum += h[i] = sinc * (0.42 - 0.5 * cos(a) + 0.08 * cos(2 * a));
+  }
+  for (int i = 0; i < T; i++) dc->h[i] = h[i] / sum;
+
+  y_info("decimation by %d: %d taps, sequences of %d input frames", D, T,
+    asa_in_frames(p));
+  asa->decim = dc;
+}
+
+
+void asa_decimate(asa_t asa) {
+  asa_decim_t *const dc = asa->decim;
+  const asa_param_t *const p = &asa->param;
+  const int s = p->s, d = p->d, c = p->c, D = dc->D, T = dc->T;
+  const int16_t *const x = asa->s16le;
+
+  // The overlap of the previous sequence, unless input was dropped
+  int first = 0;
+  if (dc->valid && !asa->gap && d < s) {
+    dc->pos += d;
+    if (dc->pos + s > 2 * s) {
+      memmove(dc->y, dc->y + dc->pos * c, sizeof(*dc->y) * (s - d) * c);
+      dc->pos = 0;
+    }
+    first = s - d;
+  }
+  else dc->pos = 0;
+
+  int16_t *const y = dc->y + dc->pos * c;
+  const asa_real_t *const h = dc->h;
+  for (int m = first; m < s; m++) {
+    for (int j = 0; j < c; j++) {
+      const int16_t *const in = x + m * D * c + j;
+      asa_real_t sum = 0;
+      for (int i = 0; i < T; i++) sum += h[i] * in[i * c];
+      y[m * c + j] = max(-32768l, min(32767l, lrint(sum)));
+    }
+  }
+
+  dc->valid = 1;
+  asa->s16le = y;
+}
+
+
+void asa_free_decim(asa_t asa) {
+  free(asa->decim->h);
+  free(asa->decim->y);
+  free(asa->decim);
+  asa->decim = NULL;
+}
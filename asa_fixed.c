@@ -0,0 +1,177 @@
+#include <stdlib.h>
+#include <string.h>
+#include <tgmath.h>
+#include "asa.h"
+#include "y_dbg.h"
+
+
+// Fixed-point engine for cores without a fast fpu (-e fixed, the default of
+// make FIXED=1).
+//
+// Integers from the samples to the lines: the window is a Q15 table (1.0 is
+// 32768), the windowed samples are 16-bit. The real fft of the n samples is a
+// complex fft of N = n / 2 points z[t] = x[2t] + j x[2t + 1] (radix-2,
+// decimation in time, twiddles in Q15) and a split step for the bins b0 to b1
+// only:
+//   X[k] = (Z[k] + Z[N - k]*) / 2 - j e^(-2 pi j k / n) (Z[k] - Z[N - k]*) / 2
+// The fft isn't scaled: a bin sums at most n samples of 15 bits, that fits in
+// 32 bits for n <= 32768, and the bins have the units of the fft engine.
+// Magnitudes are approximated by alpha max plus beta min, max(M, 7/8 M +
+// 1/2 m) with M and m the larger and the smaller of |re| and |im| (-3% to
+// +0.8%), only shifts. The bins are summed to lines in 64 bits, just the l
+// lines are converted for the scaling.
+
+#define Q15 32768
+
+typedef struct asa_fixed_t {
+  int N;                  // points of the complex fft: n / 2
+  int16_t *w;             // window of the s samples in Q15
+  int *rev;               // bit reversal of the N points
+  int32_t (*tw)[2];       // e^(-2 pi j t / N) in Q15 for t < N / 2
+  int32_t (*split)[2];    // e^(-2 pi j k / n) in Q15 for the bins b0 to b1
+  int32_t (*z)[2];        // the N points of every channel
+  uint32_t *mag;          // magnitudes of the bins b0 to b1
+} asa_fixed_t;
+
+
+void asa_init_fixed(asa_t asa) {
+  const asa_param_t *const p = &asa->param;
+  const int n = p->n, N = n / 2, s = p->s, b = p->b;
+  y_assert(n >= 16 && n <= 32768 && (n & (n - 1)) == 0);
+  y_assert(asa_batch(p) == asa_spectra(p));
+
+  asa_fixed_t *fx = calloc(1, sizeof(*fx));
+  if (!fx) y_oom();
+  fx->N = N;
+  fx->w = malloc(sizeof(*fx->w) * s);
+  fx->rev = malloc(sizeof(*fx->rev) * N);
+  fx->tw = malloc(sizeof(*fx->tw) * N / 2);
+  fx->split = malloc(sizeof(*fx->split) * b);
+  fx->z = malloc(sizeof(*fx->z) * N * asa_spectra(p));
+  fx->mag = malloc(sizeof(*fx->mag) * b);
+  if (!fx->w || !fx->rev || !fx->tw || !fx->split || !fx->z || !fx->mag)
+    y_oom();
+
+  // The window of asa_init_window(), 1.0 is just below 32768
+  for (int i = 0; i < s; i++)
+    fx->w[i] = min(32767l, lround(asa->w[i] * Q15));
+
+  for (int t = 0, bits = __builtin_ctz(N); t < N; t++) {
+    int r = 0;
+    for (int i = 0; i < bits; i++) r |= (t >> i & 1) << (bits - 1 - i);
+    fx->rev[t] = r;
+  }
+  for (int t = 0; t < N / 2; t++) {
+    fx->tw[t][0] = lround(Q15 * cos(2 * M_PI * t / N));
+    fx->tw[t][1] = lround(-Q15 * sin(2 * M_PI * t / N));
+  }
+  for (int k = 0; k < b; k++) {
+    fx->split[k][0] = lround(Q15 * cos(2 * M_PI * (p->b0 + k) / n));
+    fx->split[k][1] = lround(-Q15 * sin(2 * M_PI * (p->b0 + k) / n));
+  }
+
+  y_dbg("fixed-point engine: complex fft of %d points", N);
+  asa->fixed = fx;
+}
+
+
+// Window the samples of the channel (or the mixed ones) in Q15 to the points
+// of the fft in bit reversed order, zero-padded to n
+void asa_fixed_window(asa_t asa) {
+  const asa_fixed_t *const fx = asa->fixed;
+  const int s = asa->param.s, n = asa->param.n, c = asa->param.c;
+  const int chan = asa_spectra(&asa->param) > 1 ? asa->chan : 0;
+  const int16_t *const s16le = asa->s16le;
+  int32_t (*const z)[2] = fx->z + chan * fx->N;
+  const int i0 = (n - s) / 2;
+
+  if (s < n) memset(z, 0, sizeof(*z) * fx->N);
+  for (int i = 0; i < s; i++) {
+    int32_t sample;
+    if (c <= 1) sample = s16le[i];
+    else if (asa->chan >= 0) sample = s16le[i * c + asa->chan];
+    else {
+      sample = 0;
+      for (int j = 0; j < c; j++) sample += s16le[i * c + j];
+      sample /= c;
+    }
+    const int pos = i0 + i;
+    z[fx->rev[pos >> 1]][pos & 1] = (sample * fx->w[i] + Q15 / 2) >> 15;
+  }
+}
+
+
+// Radix-2 decimation in time on the bit reversed points
+static void asa_fixed_fft(const asa_fixed_t *fx, int32_t (*z)[2]) {
+  const int N = fx->N;
+  for (int half = 1; half < N; half <<= 1) {
+    const int step = N / (2 * half);
+    for (int j = 0; j < half; j++) {
+      const int64_t w0 = fx->tw[j * step][0], w1 = fx->tw[j * step][1];
+      for (int i = j; i < N; i += 2 * half) {
+        int32_t *const a = z[i], *const b = z[i + half];
+        const int32_t re = (b[0] * w0 - b[1] * w1 + Q15 / 2) >> 15;
+        const int32_t im = (b[0] * w1 + b[1] * w0 + Q15 / 2) >> 15;
+        b[0] = a[0] - re;
+        b[1] = a[1] - im;
+        a[0] += re;
+        a[1] += im;
+      }
+    }
+  }
+}
+
+
+void asa_fixed_run(asa_t asa) {
+  const asa_fixed_t *const fx = asa->fixed;
+  for (int j = 0; j < asa_spectra(&asa->param); j++)
+    asa_fixed_fft(fx, fx->z + j * fx->N);
+}
+
+
+void asa_fixed_lines(asa_t asa) {
+  const asa_fixed_t *const fx = asa->fixed;
+  const asa_param_t *const p = &asa->param;
+  const int N = fx->N, b = p->b;
+  const int chan = asa_spectra(p) > 1 ? asa->chan : 0;
+  const int32_t (*const z)[2] = (const int32_t (*)[2])fx->z + chan * N;
+  uint32_t *const mag = fx->mag;
+
+  // Split, Z[N] is Z[0]
+  for (int i = 0; i < b; i++) {
+    const int k = p->b0 + i;
+    const int32_t *const zk = z[k % N], *const zn = z[(N - k) % N];
+    const int64_t er = (int64_t)zk[0] + zn[0], ei = (int64_t)zk[1] - zn[1];
+    const int64_t dr = (int64_t)zk[0] - zn[0], di = (int64_t)zk[1] + zn[1];
+    const int64_t c = fx->split[i][0], s = fx->split[i][1];
+    const int64_t re = (er * Q15 + c * di + s * dr) >> 16;
+    const int64_t im = (ei * Q15 + s * di - c * dr) >> 16;
+
+    const uint32_t ar = re < 0 ? -re : re, ai = im < 0 ? -im : im;
+    const uint32_t M = ar > ai ? ar : ai, m = ar > ai ? ai : ar;
+    const uint32_t approx = M - (M >> 3) + (m >> 1);
+    mag[i] = approx > M ? approx : M;
+  }
+
+  // Lines like asa_lines()
+  const int *const g = p->g;
+  asa_real_t *const d = asa->d;
+  for (int i = 0, j = 0; i < p->l; i++) {
+    uint64_t sum = 0;
+    for (const int end = j + g[i]; j < end; j++) sum += mag[j];
+    d[i] = sum * asa->rg[i];
+  }
+}
+
+
+void asa_free_fixed(asa_t asa) {
+  asa_fixed_t *const fx = asa->fixed;
+  free(fx->w);
+  free(fx->rev);
+  free(fx->tw);
+  free(fx->split);
+  free(fx->z);
+  free(fx->mag);
+  free(fx);
+  asa->fixed = NULL;
+}
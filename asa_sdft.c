@@ -0,0 +1,191 @@
+#include <stdlib.h>
+#include <tgmath.h>
+#include "asa.h"
+#include "y_dbg.h"
+
+#ifndef ASA_FIXED // the resync needs the fft of fftw
+
+
+// Sliding dft engine for hops much smaller than the sequence (d << s).
+//
+// The dft of the n samples from t on, X_t[k] = sum x[t+i] e^(-2 pi j k i / n),
+// gives the one of the samples from t+1 on with O(1) work per bin:
+//   X_t+1[k] = (X_t[k] - x[t] + x[t+n]) e^(2 pi j k / n)
+// so a hop of d samples costs O(d b) instead of O(n log n) for the fft.
+//
+// The window is applied to the bins: multiplying with the periodic cosine sum
+// a0 - a1 cos(2 pi i / n) + a2 cos(4 pi i / n) - ... convolves the bins with
+// the taps a0, -a1/2, a2/2, ... to both sides. So the bins b0 - taps to
+// b1 + taps are tracked. Note the fft engine uses the symmetric windows (over
+// n - 1), the difference is tiny for large n.
+//
+// Rounding errors pile up with every sample, so now and then the bins are
+// taken from the fft of the unwindowed samples instead (resync), also after
+// live mode dropped input. The bins and the samples are kept in double
+// precision, also in the float build.
+
+#define SDFT_RESYNC 16 // resync after sliding over 16 * n samples
+
+typedef struct asa_sdft_t {
+  int k0;             // first tracked bin: b0 - taps
+  int num;            // number of tracked bins: b + 2 * taps
+  int taps;           // window taps on each side
+  double h[5];        // window taps: a0, -a1/2, a2/2, -a3/2, a4/2
+  double (*tw)[2];    // e^(2 pi j k / n) of the tracked bins
+  double (*x)[2];     // tracked bins of every channel
+  double *hist;       // last n samples of every channel, circular at pos
+  double *delta;      // new minus old samples of a hop
+  int pos;            // oldest sample in hist
+  int hops;           // sequences since resync, 0: resync this sequence
+  int resync;         // sequences between resyncs
+} asa_sdft_t;
+
+
+void asa_init_sdft(asa_t asa) {
+  const asa_param_t *const p = &asa->param;
+  const int spectra = asa_spectra(p);
+  y_assert(p->n == p->s && asa_batch(p) == spectra);
+
+  asa_sdft_t *sd = calloc(1, sizeof(*sd));
+  if (!sd) y_oom();
+
+  // Constant-Q lines need the bins unwindowed, their kernels have the window
+  const double *const a = window_cosines[p->q ? W_BOXCAR : p->w];
+  for (int t = 0; t < 5; t++) {
+    sd->h[t] = t == 0 ? a[0] : t % 2 ? -a[t] / 2 : a[t] / 2;
+    if (a[t]) sd->taps = t;
+  }
+  sd->k0 = p->b0 - sd->taps;
+  sd->num = p->b + 2 * sd->taps;
+
+  sd->tw = malloc(sizeof(*sd->tw) * sd->num);
+  sd->x = malloc(sizeof(*sd->x) * sd->num * spectra);
+  sd->hist = malloc(sizeof(*sd->hist) * p->n * spectra);
+  sd->delta = malloc(sizeof(*sd->delta) * p->n);
+  if (!sd->tw || !sd->x || !sd->hist || !sd->delta) y_oom();
+
+  for (int i = 0; i < sd->num; i++) {
+    double phi = 2 * M_PI * (sd->k0 + i) / p->n;
+    sd->tw[i][0] = cos(phi);
+    sd->tw[i][1] = sin(phi);
+  }
+
+  // Skipped samples (d > s) are gone, so there is nothing to slide over
+  sd->resync = p->d >= p->s ? 1 : SDFT_RESYNC * p->n / p->d;
+  y_dbg("sliding dft of %d bins with %d window taps, resync every %d "
+    "sequences", sd->num, sd->taps, sd->resync);
+
+  asa->sdft = sd;
+}
+
+
+// Sample i of the channel (or of the mixed channels) in the current sequence
+static inline double asa_sample(asa_t asa, int i) {
+  const int c = asa->param.c;
+  if (c <= 1) return asa->s16le[i];
+
+  const int16_t *const frame = asa->s16le + i * c;
+  if (asa->chan >= 0) return frame[asa->chan];
+
+  int mix = 0;
+  for (int j = 0; j < c; j++) mix += frame[j];
+  return mix / (double)c;
+}
+
+
+// Windowed bins b0 to b1 of the tracked bins for asa_lines()
+static void asa_sdft_bins(asa_sdft_t *sd, double (*x)[2], FFTW(complex) *c,
+    int b) {
+  const int taps = sd->taps;
+  for (int i = 0; i < b; i++) {
+    const double (*const xi)[2] = x + i + taps;
+    double re = sd->h[0] * xi[0][0], im = sd->h[0] * xi[0][1];
+    for (int t = 1; t <= taps; t++) {
+      re += sd->h[t] * (xi[-t][0] + xi[t][0]);
+      im += sd->h[t] * (xi[-t][1] + xi[t][1]);
+    }
+    c[i][0] = re;
+    c[i][1] = im;
+  }
+}
+
+
+void asa_sdft_window(asa_t asa) {
+  asa_sdft_t *const sd = asa->sdft;
+  const int n = asa->param.n, d = asa->param.d, num = sd->num;
+  const int chan = asa_spectra(&asa->param) > 1 ? asa->chan : 0;
+  double *const hist = sd->hist + chan * n;
+  if (asa->gap) sd->hops = 0;
+
+  // Resync: the unwindowed samples go to the fft in asa_sdft_run()
+  if (sd->hops == 0) {
+    for (int i = 0; i < n; i++) asa->d[i] = hist[i] = asa_sample(asa, i);
+    return;
+  }
+
+  // The last d samples of the sequence are new, the oldest d go
+  double *const delta = sd->delta;
+  for (int i = 0, pos = sd->pos; i < d; i++) {
+    double sample = asa_sample(asa, n - d + i);
+    delta[i] = sample - hist[pos];
+    hist[pos] = sample;
+    if (++pos == n) pos = 0;
+  }
+
+  double (*const x)[2] = sd->x + chan * num;
+  for (int k = 0; k < num; k++) {
+    const double tw0 = sd->tw[k][0], tw1 = sd->tw[k][1];
+    double re = x[k][0], im = x[k][1];
+    for (int i = 0; i < d; i++) {
+      const double r = re + delta[i];
+      re = r * tw0 - im * tw1;
+      im = r * tw1 + im * tw0;
+    }
+    x[k][0] = re;
+    x[k][1] = im;
+  }
+
+  asa_sdft_bins(sd, x, asa->c + asa->param.b0, asa->param.b);
+}
+
+
+void asa_sdft_run(asa_t asa) {
+  asa_sdft_t *const sd = asa->sdft;
+  const int n = asa->param.n, m = asa->param.m, num = sd->num;
+
+  if (sd->hops == 0) {
+    FFTW(execute_dft_r2c)(asa->plan, asa->dk, asa->ck);
+
+    // Tracked bins below 0 or above n / 2 are mirrored: X[n - k] = X[k]*
+    for (int j = 0; j < asa_spectra(&asa->param); j++) {
+      double (*const x)[2] = sd->x + j * num;
+      FFTW(complex) *const c = asa->ck + j * m;
+      for (int i = 0; i < num; i++) {
+        int k = ((sd->k0 + i) % n + n) % n;
+        int conj = k > n / 2;
+        if (conj) k = n - k;
+        x[i][0] = c[k][0];
+        x[i][1] = conj ? -c[k][1] : c[k][1];
+      }
+      asa_sdft_bins(sd, x, c + asa->param.b0, asa->param.b);
+    }
+    sd->pos = 0;
+    y_trc("sliding dft resynced after seq #%d", asa->num_in);
+  }
+  else sd->pos = (sd->pos + asa->param.d) % n;
+
+  if (++sd->hops == sd->resync) sd->hops = 0;
+}
+
+
+void asa_free_sdft(asa_t asa) {
+  asa_sdft_t *const sd = asa->sdft;
+  free(sd->tw);
+  free(sd->x);
+  free(sd->hist);
+  free(sd->delta);
+  free(sd);
+  asa->sdft = NULL;
+}
+
+#endif
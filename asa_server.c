@@ -0,0 +1,124 @@
+#include <stdatomic.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "asa.h"
+#include "y_dbg.h"
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+
+// Server mode: many streams in one process. Inputs are non-blocking and
+// polled with one epoll instance shared by a pool of workers. EPOLLONESHOT
+// hands a ready stream to exactly one worker, which processes what is there
+// until its input would block and then arms the stream again. Inputs that
+// can't be polled (regular files) are processed by the first free workers.
+//
+// When the last stream ends an eventfd, polled level-triggered, becomes
+// readable and wakes all workers for good. Fifos are opened read-write by
+// parse_args(), so they never end and wait for a writer that starts late.
+
+typedef struct asa_server_t {
+  asa_t streams;
+  int num;
+  int epfd;
+  int done;               // eventfd, readable when no stream is left
+  asa_t *files;           // streams with inputs that can't be polled
+  int num_files;
+  atomic_int next_file;   // ticket: next of files for a worker
+  atomic_int live;        // streams not at end of file
+} asa_server_t;
+
+
+static void asa_end_stream(asa_server_t *server, asa_t asa) {
+  y_dbg("stream fd %d ended: %d sequences read, %d spectrums written",
+    asa->fd_in, asa->num_in, asa->num_out);
+
+  if (atomic_fetch_sub(&server->live, 1) > 1) return;
+  if (eventfd_write(server->done, 1) == -1) y_error("eventfd: %s", y_strerr);
+}
+
+
+static void *asa_server_worker(void *arg) {
+  asa_server_t *server = arg;
+
+  for (int i; (i = atomic_fetch_add(&server->next_file, 1))
+      < server->num_files; ) {
+    asa_process(server->files[i]);
+    asa_end_stream(server, server->files[i]);
+  }
+
+  while (1) {
+    struct epoll_event ev;
+    int num = epoll_wait(server->epfd, &ev, 1, -1);
+    if (num == -1 && errno == EINTR) continue;
+    if (num == -1) y_error("epoll_wait: %s", y_strerr);
+
+    asa_t asa = ev.data.ptr;
+    if (!asa) break; // done
+
+    if (asa_process(asa) == 0) {
+      epoll_ctl(server->epfd, EPOLL_CTL_DEL, asa->fd_in, NULL);
+      asa_end_stream(server, asa);
+      continue;
+    }
+
+    // The next worker to get the stream sees everything done here, the epoll
+    // calls order it (thread sanitizers don't know that of EPOLL_CTL_MOD)
+    ev.events = EPOLLIN | EPOLLONESHOT;
+    if (epoll_ctl(server->epfd, EPOLL_CTL_MOD, asa->fd_in, &ev) == -1)
+      y_error("epoll_ctl: %s", y_strerr);
+  }
+
+  return NULL;
+}
+
+
+void asa_run_server(asa_t streams, int num, int t) {
+  asa_server_t server = { .streams = streams, .num = num };
+  atomic_init(&server.next_file, 0);
+  atomic_init(&server.live, num);
+
+  server.epfd = epoll_create1(EPOLL_CLOEXEC);
+  if (server.epfd == -1) y_error("epoll_create1: %s", y_strerr);
+  server.done = eventfd(0, EFD_CLOEXEC);
+  if (server.done == -1) y_error("eventfd: %s", y_strerr);
+
+  struct epoll_event ev = { .events = EPOLLIN, .data.ptr = NULL };
+  if (epoll_ctl(server.epfd, EPOLL_CTL_ADD, server.done, &ev) == -1)
+    y_error("epoll_ctl: %s", y_strerr);
+
+  server.files = malloc(sizeof(*server.files) * num);
+  if (!server.files) y_oom();
+  for (int i = 0; i < num; i++) {
+    asa_t asa = streams + i;
+    ev = (struct epoll_event){ EPOLLIN | EPOLLONESHOT, { .ptr = asa } };
+    if (epoll_ctl(server.epfd, EPOLL_CTL_ADD, asa->fd_in, &ev) == 0) continue;
+    if (errno != EPERM) y_error("epoll_ctl: %s", y_strerr);
+    server.files[server.num_files++] = asa;
+  }
+
+  pthread_t threads[t];
+  for (int i = 0; i < t; i++)
+    if (pthread_create(threads + i, NULL, asa_server_worker, &server))
+      y_error("creating server worker thread failed");
+  y_info("serving %d streams (%d files) with %d workers",
+    num, server.num_files, t);
+
+  for (int i = 0; i < t; i++) pthread_join(threads[i], NULL);
+
+  free(server.files);
+  close(server.done);
+  close(server.epfd);
+}
+
+#else
+
+void asa_run_server(asa_t streams, int num, int t) {
+  y_error("server mode needs epoll (Linux)");
+}
+
+#endif
@@ -0,0 +1,94 @@
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include "asa.h"
+#include "y_dbg.h"
+
+
+// Spectrum output ring in POSIX shared memory (-M).
+//
+// Every slot is a frame: the spectrums of all channels of a sequence in the
+// output format. The writer never waits for readers: it overwrites the oldest
+// slot, so a reader too slow for all frames gets the latest one or misses
+// some, but never stalls auspan. The slots are seqlocks: the sequence number
+// of a slot is odd while the writer fills it and 2 (num + 1) when frame num
+// is in it, so a reader copies the frame and checks the sequence number
+// didn't change meanwhile. head is the number of frames published.
+
+
+static inline asa_shm_slot_t *asa_shm_slot(const asa_shm_t *shm, uint64_t num) {
+  return (asa_shm_slot_t*)((char*)shm + ASA_SHM_DATA
+    + num % shm->slots * shm->slot_size);
+}
+
+
+void asa_init_shm(asa_t asa) {
+  const asa_param_t *const p = &asa->param;
+  const size_t frame = asa->out_size;
+  const size_t slot_size = (sizeof(asa_shm_slot_t) + frame + 63) / 64 * 64;
+  const size_t size = ASA_SHM_DATA + p->slots * slot_size;
+
+  // A new object: readers of an earlier run keep their (stale) mapping
+  shm_unlink(p->shm);
+  int fd = shm_open(p->shm, O_RDWR | O_CREAT | O_EXCL, 0644);
+  if (fd == -1) y_error("shm_open '%s': %s", p->shm, y_strerr);
+  if (ftruncate(fd, size) == -1) y_error("ftruncate shm: %s", y_strerr);
+  asa_shm_t *shm = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (shm == MAP_FAILED) y_error("mmap shm: %s", y_strerr);
+  close(fd);
+
+  shm->version = ASA_HEADER_VERSION;
+  shm->format = p->format;
+  shm->spectra = asa_spectra(p);
+  shm->l = p->l;
+  shm->floor = p->format == O_DB ? p->floor : 0;
+  shm->hop = p->d * p->r * asa_decim(p);
+  shm->frame = frame;
+  shm->slot_size = slot_size;
+  shm->slots = p->slots;
+  atomic_store_explicit(&shm->head, 0, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+  memcpy(shm->magic, "ASPM", 4); // last: the header is complete
+
+  asa->shm = shm;
+  asa->shm_size = size;
+  y_info("output to shared memory '%s': %d slots of %zu bytes", p->shm,
+    p->slots, frame);
+}
+
+
+void asa_shm_publish(asa_t asa) {
+  asa_shm_t *const shm = asa->shm;
+  const uint64_t num = atomic_load_explicit(&shm->head, memory_order_relaxed);
+  asa_shm_slot_t *const slot = asa_shm_slot(shm, num);
+
+  atomic_store_explicit(&slot->seq, 2 * num + 1, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+  memcpy(slot->data, asa->out, shm->frame);
+  atomic_store_explicit(&slot->seq, 2 * num + 2, memory_order_release);
+  atomic_store_explicit(&shm->head, num + 1, memory_order_release);
+}
+
+
+int asa_shm_read(const asa_shm_t *shm, uint64_t num, uint8_t *frame) {
+  const asa_shm_slot_t *const slot = asa_shm_slot(shm, num);
+  if (num >= atomic_load_explicit(&shm->head, memory_order_acquire)) return 0;
+
+  // The frame is published, unless a later frame is (being) written
+  const uint64_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+  if (seq != 2 * num + 2) return -1;
+
+  memcpy(frame, slot->data, shm->frame);
+  atomic_thread_fence(memory_order_acquire);
+  return atomic_load_explicit(&slot->seq, memory_order_relaxed) == seq ? 1 : -1;
+}
+
+
+void asa_free_shm(asa_t asa) {
+  munmap(asa->shm, asa->shm_size);
+  shm_unlink(asa->param.shm);
+  asa->shm = NULL;
+}
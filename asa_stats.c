@@ -0,0 +1,223 @@
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <pthread.h>
+#include <poll.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "asa.h"
+#include "y_dbg.h"
+
+const char* stage_names[] = {
+  "read", "window", "fft", "lines", "write"
+};
+
+const char* counter_names[] = {
+  "sequences", "spectrums", "short reads", "skipped bytes", "stale bytes",
+  "dropped spectrums", "writes"
+};
+
+#ifndef ASA_NO_STATS
+
+// Histograms like HdrHistogram with 3 significant bits: values below 8 have
+// a bucket each, above that 8 buckets per power of 2, so a bucket is at most
+// 12.5% wide. 496 buckets cover all uint64_t values (ns: 584 years).
+#define BUCKETS 496
+
+typedef struct asa_stats_t {
+  atomic_ullong hist[T_STAGES][BUCKETS];
+  atomic_ullong ns[T_STAGES];           // sum for the mean
+  atomic_ullong count[N_COUNTERS];
+} asa_stats_t;
+
+
+static int asa_bucket(uint64_t ns) {
+  if (ns < 8) return ns;
+  int e = 63 - __builtin_clzll(ns);
+  return (e - 2) * 8 + (ns >> (e - 3) & 7);
+}
+
+
+// Lowest value of bucket i
+static uint64_t asa_bucket_ns(int i) {
+  if (i < 8) return i;
+  return (uint64_t)(8 + i % 8) << (i / 8 - 1);
+}
+
+
+void asa_init_stats(asa_t asa) {
+  asa->stats = calloc(1, sizeof(*asa->stats));
+  if (!asa->stats) y_oom();
+}
+
+
+void asa_stats_time(asa_stats_t *stats, int stage, uint64_t ns) {
+  atomic_fetch_add_explicit(&stats->hist[stage][asa_bucket(ns)], 1,
+    memory_order_relaxed);
+  atomic_fetch_add_explicit(&stats->ns[stage], ns, memory_order_relaxed);
+}
+
+
+void asa_stats_add(asa_stats_t *stats, int counter, uint64_t n) {
+  atomic_fetch_add_explicit(&stats->count[counter], n, memory_order_relaxed);
+}
+
+
+// Counters, then per stage the number of timings, mean, percentiles and max
+static void asa_stats_dump(FILE *out, asa_t asas, int num) {
+  for (int a = 0; a < num; a++) {
+    asa_stats_t *const stats = asas[a].stats;
+    if (!stats) continue;
+
+    fprintf(out, "stream #%d:", a);
+    for (int i = 0; i < N_COUNTERS; i++)
+      fprintf(out, " %s %llu", counter_names[i],
+        atomic_load_explicit(&stats->count[i], memory_order_relaxed));
+    fputs("\n", out);
+
+    for (int stage = 0; stage < T_STAGES; stage++) {
+      uint64_t hist[BUCKETS], total = 0;
+      for (int i = 0; i < BUCKETS; i++) {
+        hist[i] = atomic_load_explicit(&stats->hist[stage][i],
+          memory_order_relaxed);
+        total += hist[i];
+      }
+      fprintf(out, "  %-6s n %llu", stage_names[stage],
+        (unsigned long long)total);
+      if (!total) { fputs("\n", out); continue; }
+
+      uint64_t ns = atomic_load_explicit(&stats->ns[stage],
+        memory_order_relaxed);
+      fprintf(out, " mean %llu ns", (unsigned long long)(ns / total));
+
+      static const int percents[] = { 50, 90, 99 };
+      uint64_t sum = 0;
+      int i = 0, max = 0;
+      for (int p = 0; p < 3; p++) {
+        for (; i < BUCKETS && sum + hist[i] < total * percents[p] / 100.0;
+            i++)
+          sum += hist[i];
+        fprintf(out, " p%d %llu", percents[p],
+          (unsigned long long)asa_bucket_ns(min(i, BUCKETS - 1)));
+      }
+      for (int j = 0; j < BUCKETS; j++) if (hist[j]) max = j;
+      fprintf(out, " max %llu\n", (unsigned long long)asa_bucket_ns(max));
+    }
+  }
+  fflush(out);
+}
+
+
+// SIGUSR1 writes to a pipe (only async-signal-safe write() in the handler of
+// whatever thread gets it), the stats thread then dumps to stderr; clients of
+// the unix socket get a dump too
+static int stats_pipe[2] = { -1, -1 };
+static int stats_listen = -1;
+static char *stats_path = NULL;
+static pthread_t stats_thread;
+static asa_t stats_asas;
+static int stats_num;
+
+
+static void asa_stats_signal(int sig) {
+  int saved = errno;
+  if (write(stats_pipe[1], "", 1)) {} // a full pipe has a dump pending
+  errno = saved;
+}
+
+
+static void *asa_stats_serve(void *arg) {
+  struct pollfd fds[2] = {
+    { .fd = stats_pipe[0], .events = POLLIN },
+    { .fd = stats_listen, .events = POLLIN },
+  };
+  while (1) {
+    pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
+    int num = poll(fds, stats_listen == -1 ? 1 : 2, -1);
+    pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL); // not in stdio
+    if (num == -1 && errno == EINTR) continue;
+    if (num == -1) y_error("poll stats: %s", y_strerr);
+
+    if (fds[0].revents) {
+      char buf[64];
+      if (read(stats_pipe[0], buf, sizeof(buf)) > 0)
+        asa_stats_dump(stderr, stats_asas, stats_num);
+    }
+
+    if (stats_listen != -1 && fds[1].revents) {
+      int fd = accept(stats_listen, NULL, NULL);
+      if (fd == -1) { y_warn("accept stats: %s", y_strerr); continue; }
+      FILE *out = fdopen(fd, "w");
+      if (!out) { close(fd); continue; }
+      asa_stats_dump(out, stats_asas, stats_num);
+      fclose(out);
+    }
+  }
+  return NULL;
+}
+
+
+void asa_start_stats(asa_t asas, int num, char *path) {
+  stats_asas = asas;
+  stats_num = num;
+
+  if (pipe(stats_pipe) == -1) y_error("pipe: %s", y_strerr);
+  for (int i = 0; i < 2; i++) {
+    fcntl(stats_pipe[i], F_SETFL, O_NONBLOCK);
+    fcntl(stats_pipe[i], F_SETFD, FD_CLOEXEC);
+  }
+
+  struct sigaction sa = { .sa_handler = asa_stats_signal };
+  sa.sa_flags = SA_RESTART;
+  sigemptyset(&sa.sa_mask);
+  if (sigaction(SIGUSR1, &sa, NULL) == -1) y_error("sigaction: %s", y_strerr);
+
+  if (path) {
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof(addr.sun_path)) y_error("-U path too long");
+    strcpy(addr.sun_path, path);
+
+    stats_listen = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (stats_listen == -1) y_error("socket: %s", y_strerr);
+    unlink(path); // left over from an earlier run
+    if (bind(stats_listen, (struct sockaddr*)&addr, sizeof(addr)) == -1)
+      y_error("bind '%s': %s", path, y_strerr);
+    if (listen(stats_listen, 4) == -1) y_error("listen: %s", y_strerr);
+    stats_path = path;
+    y_info("stats on unix socket '%s'", path);
+  }
+
+  if (pthread_create(&stats_thread, NULL, asa_stats_serve, NULL))
+    y_error("creating stats thread failed");
+}
+
+
+void asa_stop_stats(void) {
+  if (stats_pipe[0] == -1) return;
+
+  pthread_cancel(stats_thread); // poll() is a cancellation point
+  pthread_join(stats_thread, NULL);
+  signal(SIGUSR1, SIG_DFL);
+  close(stats_pipe[0]);
+  close(stats_pipe[1]);
+  stats_pipe[0] = stats_pipe[1] = -1;
+  if (stats_listen != -1) close(stats_listen), stats_listen = -1;
+  if (stats_path) unlink(stats_path), stats_path = NULL;
+}
+
+#else
+
+void asa_init_stats(asa_t asa) {
+}
+
+void asa_start_stats(asa_t asas, int num, char *path) {
+  if (path) y_warn("stats compiled out, no unix socket '%s'", path);
+}
+
+void asa_stop_stats(void) {
+}
+
+#endif
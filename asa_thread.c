@@ -0,0 +1,203 @@
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "asa.h"
+#include "y_dbg.h"
+
+
+// Pipelined mode: a reader thread copies sequences into a ring of job slots,
+// fft workers take them by ticket and an ordered writer (the calling thread)
+// averages and writes the spectrums in sequence order.
+//
+// Job slot seq % num_jobs goes FREE -> READ (reader) -> DONE (worker) -> FREE
+// (writer). Every state change is a release store on the slot, every wait an
+// acquire load, so there are no locks. The reader can't get more than
+// num_jobs sequences ahead of the writer.
+//
+// With a spectrum per channel a job is one channel of a sequence (job seq is
+// sequence * channels + channel), so the channels are transformed in parallel.
+
+#define JOBS_PER_WORKER 4
+
+enum { JOB_FREE, JOB_READ, JOB_DONE };
+
+typedef struct asa_job_t {
+  atomic_int state;
+  atomic_long seq;        // sequence number the slot is used for
+  int16_t *s16le;         // copy of the sequence (or one channel of it)
+  asa_real_t *lines;      // lines from asa_lines()
+  asa_real_t max_mag;     // maximum magnitude of lines
+} asa_job_t;
+
+typedef struct asa_pipe_t {
+  asa_t asa;
+  int num_jobs;
+  asa_job_t *jobs;
+  atomic_long next;       // ticket: next sequence for a worker
+  atomic_long end;        // number of sequences, LONG_MAX until end of file
+} asa_pipe_t;
+
+typedef struct asa_worker_t {
+  asa_pipe_t *pipe;
+  struct asa_struct_t asa;  // copy with own fft buffers
+} asa_worker_t;
+
+
+// Spin first (a job is usually ready soon), then yield, then sleep a little
+static void backoff(int *spins) {
+  if (++*spins < 64) return;
+  if (*spins < 1024) { sched_yield(); return; }
+  nanosleep(&(struct timespec){ .tv_nsec = 50000 }, NULL);
+}
+
+
+// Wait for the slot of seq to be in state, return 0 if there is no seq
+static asa_job_t *asa_wait_job(asa_pipe_t *pipe, long seq, int state) {
+  asa_job_t *job = pipe->jobs + seq % pipe->num_jobs;
+  int spins = 0;
+  while (atomic_load_explicit(&job->state, memory_order_acquire) != state
+      || atomic_load_explicit(&job->seq, memory_order_relaxed) != seq) {
+    if (seq >= atomic_load_explicit(&pipe->end, memory_order_acquire))
+      return NULL;
+    backoff(&spins);
+  }
+  return job;
+}
+
+
+static void *asa_reader(void *arg) {
+  asa_pipe_t *pipe = arg;
+  asa_t asa = pipe->asa;
+  const int s = asa->param.s, c = asa->param.c;
+  const int spectra = asa_spectra(&asa->param);
+  const size_t size = sizeof(int16_t) * c * s;
+
+  long seq = 0;
+  for (uint64_t t0 = ASA_CLOCK(asa); asa_read(asa) > 0; t0 = ASA_CLOCK(asa)) {
+    ASA_TIME(asa, T_READ, t0);
+    for (int chan = 0; chan < spectra; chan++, seq++) {
+      asa_job_t *job = pipe->jobs + seq % pipe->num_jobs;
+      int spins = 0;
+      while (atomic_load_explicit(&job->state, memory_order_acquire)
+          != JOB_FREE)
+        backoff(&spins);
+
+      // The copy de-interleaves the channel of the job, if there are any
+      if (spectra == 1) memcpy(job->s16le, asa->s16le, size);
+      else
+        for (int i = 0; i < s; i++) job->s16le[i] = asa->s16le[i * c + chan];
+      atomic_store_explicit(&job->seq, seq, memory_order_relaxed);
+      atomic_store_explicit(&job->state, JOB_READ, memory_order_release);
+    }
+  }
+
+  atomic_store_explicit(&pipe->end, seq, memory_order_release);
+  return NULL;
+}
+
+
+static void *asa_worker(void *arg) {
+  asa_pipe_t *pipe = ((asa_worker_t*)arg)->pipe;
+  asa_t w = &((asa_worker_t*)arg)->asa;
+
+  const size_t size = sizeof(asa_real_t) * w->param.l;
+  while (1) {
+    long seq = atomic_fetch_add_explicit(&pipe->next, 1, memory_order_relaxed);
+    asa_job_t *job = asa_wait_job(pipe, seq, JOB_READ);
+    if (!job) break;
+
+    w->s16le = job->s16le;
+    uint64_t t0 = ASA_CLOCK(w);
+    asa_pad_and_window(w);
+    ASA_TIME(w, T_WINDOW, t0);
+    t0 = ASA_CLOCK(w);
+    asa_run_fft(w);
+    ASA_TIME(w, T_FFT, t0);
+    t0 = ASA_CLOCK(w);
+    asa_lines(w);
+    ASA_TIME(w, T_LINES, t0);
+    memcpy(job->lines, w->d, size);
+    job->max_mag = w->max_mag;
+    atomic_store_explicit(&job->state, JOB_DONE, memory_order_release);
+  }
+
+  return NULL;
+}
+
+
+void asa_run_threads(asa_t asa, int t) {
+  asa_pipe_t pipe = { .asa = asa, .num_jobs = JOBS_PER_WORKER * t };
+  atomic_init(&pipe.next, 0);
+  atomic_init(&pipe.end, LONG_MAX);
+
+  pipe.jobs = calloc(pipe.num_jobs, sizeof(*pipe.jobs));
+  if (!pipe.jobs) y_oom();
+  for (int i = 0; i < pipe.num_jobs; i++) {
+    asa_job_t *job = pipe.jobs + i;
+    atomic_init(&job->state, JOB_FREE);
+    atomic_init(&job->seq, -1);
+    job->s16le = malloc(sizeof(*job->s16le) * asa->param.c * asa->param.s);
+    job->lines = malloc(sizeof(*job->lines) * asa->param.l);
+    if (!job->s16le || !job->lines) y_oom();
+  }
+
+  // Workers have own fft buffers, the plan is shared: fftw_execute_dft_r2c()
+  // is thread safe and fftw_alloc_*() gives the alignment the plan needs.
+  // Jobs of one channel are mono for the workers.
+  const int spectra = asa_spectra(&asa->param);
+  asa_worker_t workers[t];
+  for (int i = 0; i < t; i++) {
+    asa_t w = &workers[i].asa;
+    workers[i].pipe = &pipe;
+    *w = *asa;
+    if (spectra > 1) w->param.c = 1;
+    w->chan = asa->param.mix ? -1 : 0;
+    w->d = w->dk = FFTW(alloc_real)(w->param.n);
+    w->c = w->ck = FFTW(alloc_complex)(w->param.m);
+    if (!w->d || !w->c) y_oom();
+    memset(w->d, 0, sizeof(*w->d) * w->param.n);
+    w->dirty = 0;
+  }
+
+  pthread_t reader, threads[t];
+  for (int i = 0; i < t; i++)
+    if (pthread_create(threads + i, NULL, asa_worker, workers + i))
+      y_error("creating worker thread failed");
+  if (pthread_create(&reader, NULL, asa_reader, &pipe))
+    y_error("creating reader thread failed");
+  y_dbg("pipeline with %d workers and %d job slots", t, pipe.num_jobs);
+
+  // Ordered writer
+  asa_real_t *const d = asa->d;
+  for (long seq = 0; ; seq++) {
+    asa_job_t *job = asa_wait_job(&pipe, seq, JOB_DONE);
+    if (!job) break;
+
+    asa->d = job->lines;
+    asa->max_mag = job->max_mag;
+    asa->chan = seq % spectra;
+    uint64_t t0 = ASA_CLOCK(asa);
+    if (asa_average(asa)) asa_write(asa);
+    ASA_TIME(asa, T_WRITE, t0);
+    atomic_store_explicit(&job->state, JOB_FREE, memory_order_release);
+  }
+  asa->d = d;
+  asa_flush(asa);
+
+  pthread_join(reader, NULL);
+  for (int i = 0; i < t; i++) {
+    pthread_join(threads[i], NULL);
+    FFTW(free)(workers[i].asa.d);
+    FFTW(free)(workers[i].asa.c);
+  }
+
+  for (int i = 0; i < pipe.num_jobs; i++) {
+    free(pipe.jobs[i].s16le);
+    free(pipe.jobs[i].lines);
+  }
+  free(pipe.jobs);
+}
@@ -1,5 +1,4 @@
 #include "asa.h"
-#include <fftw3.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <stddef.h>
@@ -12,7 +11,6 @@
 #include <fcntl.h>
 #include <sys/stat.h>
 
-#define Y_DBG_MAIN
 #include "y_dbg.h"
 
 
@@ -30,14 +28,19 @@ static void version() {
 
 
 __attribute__((noreturn))
-static void usage(char* msg) {
+static void usage(const char* msg) {
   if (msg) fprintf(stderr, "\e[31;1mError: %s\e[m\n", msg);
   fputs(
     "Analyse audio and generate spectrums\n"
     "Usage: " PROGRAM " [options] [input-file [output-file]]\n"
+    "       " PROGRAM " -S config-file [-t threads] [-U stats-socket]\n"
     "  where input-file is a s16le pcm source und output-file a file to\n"
     "  which u8 spectrum data is APPENDED to; s16le is signed 16-bit little\n"
     "  endian and u8 unsigned 8-bit integer\n"
+    "  -S serves many streams in one process: every line of config-file has\n"
+    "  options, input-file and output-file of a stream (# starts a comment),\n"
+    "  -t is the number of worker threads, default the number of cores;\n"
+    "  a fifo of a stream may get its writer later, it never ends\n"
     "\n"
     "Options: (x = 2^20 = 1048576, m = 1 + n / 2)\n"
     "  -v print version                       default   limits\n"
@@ -45,7 +48,12 @@ static void usage(char* msg) {
     "  -r number of sequences per spectrum          1   1 <= r <= 999\n"
     "  -d distance between sequence starts          s   1 <= d <= x\n"
     "         or in % of s                       100%   1% <= d <= 10000%\n"
-    "     spectrums output at frequency: sampling frequency / d / r\n"
+    "     spectrums output at frequency: sampling frequency / D / d / r\n"
+    "  -f sampling frequency of the input in Hz 44100   1 <= f <= 768000\n"
+    "         (only for the frequencies printed)\n"
+    "  -D decimate the input by D: low-pass,      1   1 <= D <= 64\n"
+    "         keep every D-th frame; s, d and n count decimated frames,\n"
+    "         the fft resolves f / D / n up to about 0.4 f / D\n"
     "  -w window function, one of: boxcar hann flattop blackmanharris,\n"
     "         default hann\n"
     "  -n fft size with zero padding                s   s <= n <= x\n"
@@ -54,19 +62,86 @@ static void usage(char* msg) {
     "  -p distribute bins to the power of p         1   1 <= p <= 2\n"
     "  -l number of spectrum lines                  b   1 <= l <= b\n"
     "         if b == l then only p == 1 is allowed\n"
+    "  -q constant-Q lines: the l lines divide bins b0 to b1 logarithmically\n"
+    "         (b0 >= 1, 1 <= l <= m, no -p), each line a sparse kernel of the\n"
+    "         window over as many samples as its frequency needs (at most s)\n"
+    "  -F fft planning effort, one of: estimate measure patient exhaustive,\n"
+    "         default estimate (more effort: slower start, faster fft)\n"
+    "  -W file to import fftw wisdom from and export to after planning\n"
+    "  -i size of reads from input in bytes     65536   1 <= i <= x\n"
+    "         (regular files are mapped into memory instead)\n"
+    "  -t number of fft worker threads; with t > 1   1   1 <= t <= 64\n"
+    "         a reader and a writer thread are added\n"
+    "  -k number of sequences per fft batch         1   1 <= k <= 256\n"
+    "         (not together with -t)\n"
+    "  -e spectrum engine, one of: fft sdft fixed goertzel pruned padded\n"
+    "         auto (default " ASA_ENGINE_NAME "); auto is the cheapest of fft,\n"
+    "         goertzel, pruned and padded for the bins b0 to b1: goertzel\n"
+    "         filters just these bins, pruned combines them from P ffts of\n"
+    "         every P-th sample (n % 16 == 0, no -t), padded skips the\n"
+    "         zero padding (n >= 2 s, no -t); sdft is a sliding dft\n"
+    "         updating bins b0 to b1 by the d new samples, faster for d\n"
+    "         much smaller than s, only n == s, no -k -t; fixed is integer\n"
+    "         math in Q15 for cores without fpu, magnitudes within 3%,\n"
+    "         only n a power of 2 up to 32768, no -k -t -q (the default\n"
+    "         of make FIXED=1, which builds without fftw: only fixed and\n"
+    "         goertzel)\n"
+    "  -U unix socket giving stats to clients (like SIGUSR1 to stderr):\n"
+    "         counters and histograms of the timings of the stages\n"
+    "  -c c[,mix] number of interleaved channels    1   1 <= c <= 16\n"
+    "         a spectrum per channel, written one after the other, or\n"
+    "         with ,mix one spectrum of the mixed channels; without -t\n"
+    "         and -k the channels are processed on up to c cores\n"
+    "  -a smoothing: weight of new lines          1   0 < a <= 1\n"
+    "         (1: no smoothing, 0.3: about 3 spectrums averaged)\n"
+    "  -g gravity: lines fall, faster by g of     0   0 <= g <= 1\n"
+    "         full scale every spectrum, instead of dropping at once\n"
+    "  -H hold peaks for H spectrums               0   0 <= H <= 9999\n"
+    "  -A auto-gain: scale to the largest maximum, 0   0 <= A <= 99999\n"
+    "         halving in A spectrums; 0: every spectrum is scaled to its\n"
+    "         own maximum (flickers with quiet passages)\n"
+    "  -o output format, one of: u8 db[,floor] u16 f32 delta, default u8\n"
+    "         u8: linear, raw without header; the others start with a\n"
+    "         header (see asa.h); db: u8 from floor (default -60) to 0 dB,\n"
+    "         u16: linear little endian, f32: float 0 to 1, delta: u8\n"
+    "         lines changed since the last spectrum, run-length encoded;\n"
+    "         with a header l <= 65535\n"
+    "  -j spectrums joined into one write()       1   1 <= j <= 256\n"
+    "         (fewer syscalls at high spectrum rates, not with -L)\n"
+    "  -M name[,slots] output to a ring in POSIX shared memory instead of\n"
+    "         output-file, name like /auspan, default 16 slots (2 to 4096);\n"
+    "         consumers map it and read the latest spectrums without\n"
+    "         syscalls (see asa.h), a slow consumer never stalls auspan;\n"
+    "         not with -o delta and -j, l <= 65535\n"
+    "  -L live: analyse the newest sequence there is, dropping stale input,\n"
+    "         and drop spectrums if the output isn't ready for them; the\n"
+    "         latency stays below s + d samples plus the input buffers\n"
     "", stderr
   );
   exit(127);
 }
 
 
-static void parse_args(int argc, char **argv, asa_t asa) {
+static char *config = NULL; // -S file with the streams of the server
+static int pool = 1;        // number of server worker threads
+static char *stats = NULL;  // -U unix socket for stats
+
+
+// Parse the options and open the files; a stream of the server has -t 1 and
+// the input is non-blocking
+static void parse_args(int argc, char **argv, asa_t asa, int stream) {
   asa_param_t p = { 
     .s = 32, .n = 32, .m = 17, 
     .b0 = 1, .b1 = 15, .b = 15,
     .p = 1.0, .l = 15,
     .r = 1, .d = 32,
     .w = W_HANN,
+    .e = E_ESTIMATE, .wisdom = NULL,
+    .chunk = 65536, .t = 1, .k = 1,
+    .c = 1, .mix = 0, .engine = ASA_ENGINE, .live = 0, .q = 0,
+    .smooth = 1, .gravity = 0, .hold = 0, .gain = 0,
+    .format = O_U8, .floor = -60, .join = 1, .shm = NULL, .slots = 16,
+    .rate = 44100, .decim = 1,
   };
 
   y_trc("s %d n %d m %d b0 %d b1 %d b %d l %d p %f r %d d %d w %s",
@@ -75,8 +150,10 @@ static void parse_args(int argc, char **argv, asa_t asa) {
   char opt;
   unsigned long result;
   int s_set = 0, n_set = 0, d_set = 0, b_set = 0, l_set = 0;
+  int t_set = 0, k_set = 0, p_set = 0, j_set = 0;
 
-  while (-1 != (opt = getopt (argc, argv, "vhs:n:b:p:l:r:d:w:"))) {
+  const char *opts = "vhs:n:b:p:l:r:d:w:F:W:i:t:k:c:S:e:U:Lqa:g:H:A:o:j:M:f:D:";
+  while (-1 != (opt = getopt (argc, argv, opts))) {
     y_trc("opt %c optarg '%s' optind %d", opt, optarg, optind);
     switch (opt) {
       case 'v': version();
@@ -118,6 +195,140 @@ static void parse_args(int argc, char **argv, asa_t asa) {
         if (p.w > W_LAST) usage("-d invalid window type");
       } break;
 
+      case 'F': {
+        for (p.e = E_FIRST; p.e <= E_LAST; p.e++)
+          if (0 == strcmp(optarg, effort_names[p.e])) break;
+        if (p.e > E_LAST) usage("-F invalid planning effort");
+      } break;
+
+      case 'e': {
+        for (p.engine = X_FIRST; p.engine <= X_LAST; p.engine++)
+          if (0 == strcmp(optarg, engine_names[p.engine])) break;
+        if (p.engine > X_LAST) usage("-e invalid engine");
+      } break;
+
+      case 'W': {
+        p.wisdom = optarg;
+      } break;
+
+      case 'i': {
+        result = strtoull(optarg, NULL, 10);
+        if (result < 1 || result > x) usage("-i out of limit");
+        p.chunk = result;
+      } break;
+
+      case 't': {
+        result = strtoull(optarg, NULL, 10);
+        if (result < 1 || result > 64) usage("-t out of limit");
+        p.t = result;
+        t_set = 1;
+      } break;
+
+      case 'k': {
+        result = strtoull(optarg, NULL, 10);
+        if (result < 1 || result > 256) usage("-k out of limit");
+        p.k = result;
+        k_set = 1;
+      } break;
+
+      case 'c': {
+        char *tail;
+        result = strtoull(optarg, &tail, 10);
+        if (result < 1 || result > 16) usage("-c out of limit");
+        p.c = result;
+        if (0 == strcmp(tail, ",mix")) p.mix = 1;
+        else if (tail[0]) usage("-c malformed");
+      } break;
+
+      case 'a': {
+        char *tail;
+        p.smooth = strtod(optarg, &tail);
+        if (tail == optarg || *tail) usage("-a invalid value");
+        if (!(p.smooth > 0 && p.smooth <= 1)) usage("-a out of limit");
+      } break;
+
+      case 'g': {
+        char *tail;
+        p.gravity = strtod(optarg, &tail);
+        if (tail == optarg || *tail) usage("-g invalid value");
+        if (!(p.gravity >= 0 && p.gravity <= 1)) usage("-g out of limit");
+      } break;
+
+      case 'H': {
+        result = strtoull(optarg, NULL, 10);
+        if (result > 9999) usage("-H out of limit");
+        p.hold = result;
+      } break;
+
+      case 'A': {
+        result = strtoull(optarg, NULL, 10);
+        if (result > 99999) usage("-A out of limit");
+        p.gain = result;
+      } break;
+
+      case 'o': {
+        char *comma = strchr(optarg, ',');
+        if (comma) *comma = 0;
+        for (p.format = O_FIRST; p.format <= O_LAST; p.format++)
+          if (0 == strcmp(optarg, format_names[p.format])) break;
+        if (p.format > O_LAST) usage("-o invalid output format");
+        if (comma && p.format != O_DB) usage("-o floor only with db");
+        if (comma) {
+          p.floor = strtod(comma + 1, NULL);
+          if (!(p.floor >= -999 && p.floor < 0)) usage("-o floor out of limit");
+        }
+      } break;
+
+      case 'f': {
+        result = strtoull(optarg, NULL, 10);
+        if (result < 1 || result > 768000) usage("-f out of limit");
+        p.rate = result;
+      } break;
+
+      case 'D': {
+        result = strtoull(optarg, NULL, 10);
+        if (result < 1 || result > 64) usage("-D out of limit");
+        p.decim = result;
+      } break;
+
+      case 'j': {
+        result = strtoull(optarg, NULL, 10);
+        if (result < 1 || result > 256) usage("-j out of limit");
+        p.join = result;
+        j_set = 1;
+      } break;
+
+      case 'M': {
+        char *comma = strchr(optarg, ',');
+        if (comma) {
+          *comma = 0;
+          result = strtoull(comma + 1, NULL, 10);
+          if (result < 2 || result > 4096) usage("-M slots out of limit");
+          p.slots = result;
+        }
+        if (optarg[0] != '/' || strchr(optarg + 1, '/'))
+          usage("-M name must be like /auspan");
+        p.shm = optarg;
+      } break;
+
+      case 'q': {
+        p.q = 1;
+      } break;
+
+      case 'L': {
+        p.live = 1;
+      } break;
+
+      case 'U': {
+        if (stream) usage("-U in config-file");
+        stats = optarg;
+      } break;
+
+      case 'S': {
+        if (stream) usage("-S in config-file");
+        config = optarg;
+      } break;
+
       case 'n': {
         result = strtoll(optarg, NULL, 10);
         p.n = result;
@@ -135,6 +346,7 @@ static void parse_args(int argc, char **argv, asa_t asa) {
         int num = sscanf(optarg, "%lf", &p.p);
         if (num != 1) usage("-p invalid value");
         if (p.p < 1.0 || p.p > 2.0) usage("-p out of limit");
+        p_set = 1;
       } break;
 
       case 'l': {
@@ -147,16 +359,34 @@ static void parse_args(int argc, char **argv, asa_t asa) {
     }
   }
 
+  if (config && !stream) {
+    if (argc - optind) usage("-S takes no input-file and output-file");
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    pool = t_set ? p.t : min(cores > 1 ? (int)cores : 1, 64);
+    return;
+  }
+  if (stream && argc - optind != (p.shm ? 1 : 2))
+    usage(p.shm ? "stream with -M needs input only"
+      : "stream without input and output");
+  if (stream) p.t = 1, t_set = 1;
+
   p.m = 1 + p.n / 2;
   if (!b_set) p.b1 = p.m - 2;
   p.b = 1 + p.b1 - p.b0;
   if (!l_set) p.l = p.b;
 
-  if (p.n < p.s || p.n > x) usage("-n out of limit");
-  if (p.b0 > p.b1) usage("-b rule b0 <= b1 broken");
-  if (p.b1 > p.m - 1) usage("-b rule b1 <= m-1 broken");
-  if (p.l < 1 || p.l > p.b) usage("-l out of limit");
-  if (!(p.p == 1.0 || p.l != p.b)) usage("if b == l then only p == 1 allowed");
+  if (p.q && p_set) usage("-q and -p can't be combined");
+  const char *error = asa_check_param(&p);
+  if (error) usage(error);
+  if (p.shm && (j_set || p.format == O_DELTA))
+    usage("-M can't be combined with -j or -o delta");
+  if (p.shm && argc - optind > 1) usage("-M takes no output-file");
+  if (p.shm) p.join = asa_spectra(&p); // a frame is a sequence
+  if (!t_set && !k_set && asa_spectra(&p) > 1
+      && (p.engine == X_FFT || p.engine == X_AUTO)) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    p.t = min(asa_spectra(&p), cores > 1 ? (int)cores : 1);
+  }
   if (argc - optind > 3) usage("too many parameters");
 
   if (argc - optind == 0) {
@@ -164,13 +394,23 @@ static void parse_args(int argc, char **argv, asa_t asa) {
     y_info("stdin used as input");
   }
   else {
+    // A fifo of a stream is opened for writing too: without a writer (mpd
+    // not started yet or restarted) a non-blocking read would return 0 and
+    // end the stream, so such a stream never ends
     char *in = argv[optind + 0];
-    asa->fd_in = open(in, O_RDONLY);
+    struct stat st;
+    const int fifo = stream && stat(in, &st) == 0 && S_ISFIFO(st.st_mode);
+    asa->fd_in = open(in, (fifo ? O_RDWR : O_RDONLY)
+      | (stream ? O_NONBLOCK : 0));
     if (asa->fd_in == -1) y_error("open input: %s", y_strerr);
-    y_dbg("'%s' opened readonly, fd %d", in, asa->fd_in);
+    y_dbg("'%s' opened %s, fd %d", in, fifo ? "readwrite" : "readonly",
+      asa->fd_in);
   }
 
-  if (argc - optind <= 1) {
+  if (p.shm) {
+    asa->fd_out = -1;
+  }
+  else if (argc - optind <= 1) {
     asa->fd_out = STDOUT_FILENO;
     y_info("stdout used as output");
   }
@@ -181,28 +421,48 @@ static void parse_args(int argc, char **argv, asa_t asa) {
     y_dbg("'%s' opened writeonly append, fd %d", out, asa->fd_out);
   }
 
+  const double rate = (double)p.rate / asa_decim(&p);
+  char decimated[64];
+  snprintf(decimated, sizeof(decimated), ", decimated by D %d to %.1f",
+    p.decim, rate);
   y_info_o(Y_OUT_START, ""
-    "Running with these parameters: (f: sampling frequency)\n"
+    "Running with these parameters:\n"
+    "  f %6d         sampling frequency in Hz%s\n"
     "  w %-14s window function\n"
+    "  F %-14s fft planning effort\n"
+    "  e %-14s spectrum engine\n"
+    "  o %-14s output format, %d spectrum(s) per write\n"
+    "  c %6d         number of channels%s\n"
     "  s %6d         number of samples in a sequence%s\n"
     "  r %6d         number of sequences used per generated spectrum\n"
     "  d %6d         distance between sequence starts; spectrums come at\n"
-    "                   f / r / d, for 44.1 kHz at %.3f Hz\n"
-    "  n %6d         fft input size; frequency resolution is f / n, for\n"
-    "                   44.1 kHz it's %.3f Hz\n"
+    "                   f / D / r / d = %.3f Hz\n"
+    "  n %6d         fft input size; frequency resolution is f / D / n =\n"
+    "                   %.3f Hz\n"
     "  m %6d         fft output size\n"
     "  b %6d         number of bins total (from %d to %d)\n"
     "  p      %09.7f power distribution (p == 1 means linear)\n"
-    "  l %6d         number of lines with distribution from bins as:\n"
+    "  l %6d         number of lines%s"
     ""
+      , p.rate, p.decim > 1 ? decimated : ""
       , window_names[p.w]
+      , effort_names[p.e]
+      , engine_names[p.engine]
+      , format_names[p.format], p.join
+      , p.c, p.c == 1 ? "" : p.mix ? ", mixed" : ", spectrum per channel"
       , p.s , p.n > p.s ? ", sequence zero-padded" : ""
       , p.r, p.d
-      , 44100.0 / p.r / p.d
-      , p.n, 44100.0 / p.n
+      , rate / p.r / p.d
+      , p.n, rate / p.n
       , p.m, p.b, p.b0, p.b1
       , p.p, p.l
+      , p.q ? ", constant Q" : " with distribution from bins as:\n"
   );
+  if (p.q) {
+    y_info_o(Y_OUT_END, "");
+    asa->param = p;
+    return;
+  }
 
   p.g = asa_distribute_bins(p.l, p.b, p.p);
 
@@ -220,12 +480,67 @@ static void parse_args(int argc, char **argv, asa_t asa) {
 
 
 static struct asa_struct_t static_asa = { 0 };
+static asa_t streams = NULL;
+static int num_streams = 0;
+
+
+// One stream per line of the config-file, with arguments like the command
+// line; streams with the same fft size and batch share the fftw plan
+static void read_config(void) {
+  FILE *file = fopen(config, "r");
+  if (!file) y_error("open '%s': %s", config, y_strerr);
+
+  char line[4096];
+  for (int num = 1; fgets(line, sizeof(line), file); num++) {
+    char *hash = strchr(line, '#');
+    if (hash) *hash = 0;
+
+    char *args[64] = { PROGRAM };
+    int argc = 1;
+    const char *space = " \t\n";
+    for (char *arg = strtok(line, space); arg; arg = strtok(NULL, space)) {
+      if (argc == 64) y_error("%s:%d: too many arguments", config, num);
+      args[argc++] = arg;
+    }
+    if (argc == 1) continue;
+
+    streams = realloc(streams, sizeof(*streams) * (num_streams + 1));
+    if (!streams) y_oom();
+    asa_t asa = streams + num_streams++;
+    *asa = (struct asa_struct_t){ 0 };
+
+    y_info("%s:%d: stream #%d", config, num, num_streams - 1);
+    optind = 0; // getopt starts over (glibc)
+    parse_args(argc, args, asa, 1);
+
+    for (asa_t other = streams; other < asa; other++) {
+      if (!other->plan || other->param.n != asa->param.n) continue;
+      if (asa_batch(&other->param) != asa_batch(&asa->param)) continue;
+      asa->plan = other->plan;
+      asa->plan_shared = 1;
+      break;
+    }
+    asa_init_fft(asa); // the line is gone after this, -W included
+    asa_init_output(asa);
+    asa_init_input(asa);
+    asa_init_stats(asa);
+  }
+  if (ferror(file)) y_error("read '%s': %s", config, y_strerr);
+  fclose(file);
+
+  if (!num_streams) y_error("no streams in '%s'", config);
+}
 
 
 void exit_handler(void) {
   y_dbg("cleaning up");
-  if (static_asa.s16le) free(static_asa.s16le);
+  asa_stop_stats();
   asa_cleanup(&static_asa);
+  for (int i = 0; i < num_streams; i++) asa_cleanup(streams + i);
+  free(streams);
+#ifndef ASA_FIXED
+  FFTW(cleanup)();
+#endif
 }
 
 
@@ -235,19 +550,21 @@ int main(int argc, char **argv) {
   y_info("%s", COMPILE);
 
   asa_t asa = &static_asa;
-  parse_args(argc, argv, asa);
+  parse_args(argc, argv, asa, 0);
+  if (config) {
+    read_config();
+    asa_start_stats(streams, num_streams, stats);
+    asa_run_server(streams, num_streams, pool);
+    return 0;
+  }
   asa_init_fft(asa);
-  asa_param_t p = asa->param;
+  asa_init_output(asa);
+  asa_init_input(asa);
+  asa_init_stats(asa);
+  asa_start_stats(asa, 1, stats);
 
-  asa->s16le = malloc(sizeof(int16_t) * p.s);
-  if (!asa->s16le) y_oom();
-
-  while (asa_read(asa)) {
-    asa_pad_and_window(asa);
-    asa_run_fft(asa);
-    asa_lines(asa);
-    asa_write(asa);
-  }
+  if (asa->param.t > 1) asa_run_threads(asa, asa->param.t);
+  else asa_process(asa);
 
   y_dbg("number of sequences read: %d", asa->num_in);
   y_dbg("number of spectrums written: %d", asa->num_out);
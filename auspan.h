@@ -0,0 +1,61 @@
+#ifndef AUSPAN_H
+#define AUSPAN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// libauspan: the analyser of auspan in-process, without fds (make lib for
+// libauspan.a and libauspan.so, link with -lfftw3 -lm -lpthread, -lfftw3f
+// of make FLOAT=1 or without fftw of make FIXED=1).
+//
+// An analyser is a handle of its own, no global state: analysers can run on
+// threads, one analyser must not be used by two threads at a time. Creating
+// and freeing plans of fftw isn't thread-safe, auspan_new() and auspan_free()
+// lock a mutex around it. fftw_cleanup() is left to the caller.
+//
+// Out of memory exits like auspan does.
+
+typedef struct auspan *auspan_t;
+
+// The options of auspan, see auspan -h; auspan_config() sets the defaults
+typedef struct auspan_config_t {
+  int s;              // -s samples in a sequence
+  int n;              // -n fft size, 0: s
+  int d;              // -d distance between sequence starts, 0: s
+  int r;              // -r sequences per spectrum
+  int b0, b1;         // -b bins, b1 -1: m - 2
+  int l;              // -l lines, 0: b
+  double p;           // -p distribute bins to the power of p
+  int q;              // -q constant-Q lines
+  const char *window; // -w window function
+  const char *engine; // -e spectrum engine
+  int c;              // -c interleaved channels
+  int mix;            // -c c,mix: one spectrum of the mixed channels
+  double smooth;      // -a smoothing
+  double gravity;     // -g gravity
+  int hold;           // -H hold peaks
+  int gain;           // -A auto-gain
+} auspan_config_t;
+
+// The defaults of auspan for sequences of s samples
+extern void auspan_config(auspan_config_t *config, int s);
+
+// A new analyser, NULL if the config is invalid (errno EINVAL, the reason is
+// in *error if error isn't NULL)
+extern auspan_t auspan_new(const auspan_config_t *config, const char **error);
+
+// Lines of a spectrum and spectrums per sequence (channels unless mixed)
+extern int auspan_lines(auspan_t a);
+extern int auspan_spectra(auspan_t a);
+
+// Analyse frames of c interleaved s16 samples: every complete spectrum goes
+// to lines, l floats from 0 to 1 (full scale) per spectrum, the spectrums of
+// the channels one after the other, at most max spectrums. Returns the number
+// of frames taken, *num the number of spectrums; frames not taken (lines was
+// full) are to be passed again. Frames of an incomplete sequence are kept.
+extern size_t auspan_process(auspan_t a, const int16_t *pcm, size_t frames,
+  float *lines, int max, int *num);
+
+extern void auspan_free(auspan_t a);
+
+#endif
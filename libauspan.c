@@ -0,0 +1,177 @@
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include "auspan.h"
+#include "asa.h"
+#include "y_dbg.h"
+
+
+// The library API of auspan.h on an asa of its own: the caller's frames are
+// collected in pcm instead of the ring of asa_read(), the lines are taken
+// after asa_scale() instead of asa_write().
+
+struct auspan {
+  struct asa_struct_t asa;
+  int16_t *pcm;           // 2 s frames: the sequence starts at frame start,
+  int start;              // frames of it so far: have
+  int have;
+  long skip;              // frames to skip before the next sequence (d > s)
+  asa_real_t *v;          // scaled lines of a spectrum
+};
+
+// Planning of fftw isn't thread-safe, only executing plans is
+static pthread_mutex_t plan_lock = PTHREAD_MUTEX_INITIALIZER;
+
+
+void auspan_config(auspan_config_t *config, int s) {
+  *config = (auspan_config_t){
+    .s = s, .r = 1, .b0 = 1, .b1 = -1, .p = 1.0,
+    .window = "hann", .engine = ASA_ENGINE_NAME, .c = 1, .smooth = 1,
+  };
+}
+
+
+auspan_t auspan_new(const auspan_config_t *config, const char **error) {
+  asa_param_t p = {
+    .s = config->s, .n = config->n ? config->n : config->s,
+    .d = config->d ? config->d : config->s, .r = config->r,
+    .b0 = config->b0, .p = config->p, .q = config->q,
+    .e = E_ESTIMATE, .t = 1, .k = 1, .c = config->c, .mix = config->mix,
+    .smooth = config->smooth, .gravity = config->gravity,
+    .hold = config->hold, .gain = config->gain, .format = O_U8, .join = 1,
+    .rate = 44100, .decim = 1,
+  };
+  p.m = 1 + p.n / 2;
+  p.b1 = config->b1 == -1 ? p.m - 2 : config->b1;
+  p.b = 1 + p.b1 - p.b0;
+  p.l = config->l ? config->l : p.b;
+
+  const char *reason = NULL;
+  for (p.w = W_FIRST; p.w <= W_LAST; p.w++)
+    if (config->window && 0 == strcmp(config->window, window_names[p.w]))
+      break;
+  for (p.engine = X_FIRST; p.engine <= X_LAST; p.engine++)
+    if (config->engine && 0 == strcmp(config->engine, engine_names[p.engine]))
+      break;
+  if (p.w > W_LAST) reason = "-w invalid window type";
+  else if (p.engine > X_LAST) reason = "-e invalid engine";
+  else reason = asa_check_param(&p);
+  if (reason) {
+    if (error) *error = reason;
+    errno = EINVAL;
+    return NULL;
+  }
+
+  auspan_t a = calloc(1, sizeof(*a));
+  if (!a) y_oom();
+  if (!p.q) p.g = asa_distribute_bins(p.l, p.b, p.p);
+  a->asa.param = p;
+  a->asa.fd_in = a->asa.fd_out = -1;
+  a->pcm = malloc(sizeof(*a->pcm) * 2 * p.s * p.c);
+  a->v = malloc(sizeof(*a->v) * p.l);
+  if (!a->pcm || !a->v) y_oom();
+
+  pthread_mutex_lock(&plan_lock);
+  asa_init_fft(&a->asa);
+  pthread_mutex_unlock(&plan_lock);
+  return a;
+}
+
+
+int auspan_lines(auspan_t a) {
+  return a->asa.param.l;
+}
+
+
+int auspan_spectra(auspan_t a) {
+  return asa_spectra(&a->asa.param);
+}
+
+
+// Window, fft and lines of the sequence in pcm, like asa_process() with a
+// batch of one sequence; returns the number of spectrums put to lines
+static int auspan_sequence(auspan_t a, float *lines) {
+  asa_t const asa = &a->asa;
+  const int l = asa->param.l, spectra = asa_spectra(&asa->param);
+  int num = 0;
+
+  asa->s16le = a->pcm + a->start * asa->param.c;
+  for (int chan = 0; chan < spectra; chan++) {
+    asa_batch_slot(asa, chan);
+    asa->chan = asa->param.mix ? -1 : chan;
+    asa_pad_and_window(asa);
+  }
+  asa_run_fft(asa);
+
+  for (int chan = 0; chan < spectra; chan++) {
+    asa_batch_slot(asa, chan);
+    asa->chan = chan;
+    asa_lines(asa);
+    if (!asa_average(asa)) continue;
+    asa_scale(asa, a->v);
+    for (int i = 0; i < l; i++) lines[num * l + i] = a->v[i] / 255;
+    num++;
+  }
+  asa->num_in++;
+  asa->num_out += num;
+  return num;
+}
+
+
+size_t auspan_process(auspan_t a, const int16_t *pcm, size_t frames,
+    float *lines, int max, int *num) {
+  const asa_param_t *const p = &a->asa.param;
+  const int s = p->s, c = p->c, d = p->d, l = p->l;
+  const int spectra = asa_spectra(p);
+  size_t taken = 0;
+
+  *num = 0;
+  while (taken < frames) {
+    if (a->skip) {
+      const size_t n = min((size_t)a->skip, frames - taken);
+      a->skip -= n;
+      taken += n;
+      continue;
+    }
+
+    // The frame completing a sequence needs room for its spectrums
+    const size_t n = min((size_t)(s - a->have), frames - taken);
+    if (a->have + n == s && *num + spectra > max) break;
+    memcpy(a->pcm + (a->start + a->have) * c, pcm + taken * c,
+      sizeof(*pcm) * n * c);
+    a->have += n;
+    taken += n;
+    if (a->have < s) break;
+
+    *num += auspan_sequence(a, lines + *num * l);
+
+    // The next sequence starts d frames later: the frames overlapping are
+    // moved to the front only every s / d sequences, skipped ones are gone
+    if (d < s) {
+      a->start += d;
+      a->have -= d;
+      if (a->start > s) {
+        memmove(a->pcm, a->pcm + a->start * c, sizeof(*pcm) * a->have * c);
+        a->start = 0;
+      }
+    }
+    else {
+      a->start = a->have = 0;
+      a->skip = d - s;
+    }
+  }
+  return taken;
+}
+
+
+void auspan_free(auspan_t a) {
+  if (!a) return;
+  free(a->asa.param.g);
+  pthread_mutex_lock(&plan_lock);
+  asa_cleanup(&a->asa);
+  pthread_mutex_unlock(&plan_lock);
+  free(a->pcm);
+  free(a->v);
+  free(a);
+}
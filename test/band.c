@@ -0,0 +1,100 @@
+#include <asa.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define Y_DBG_MAIN
+#include <y_dbg.h>
+
+__attribute__((noreturn))
+static void usage() {
+  fprintf(stderr, "Usage: band <s> <n> <b0> <b1> <engine> [k]\n"
+      "  where: 1 <= s <= n <= 65536; 1 <= b0 <= b1 < n / 2; engine one of:");
+  for (int i = 0; i <= X_LAST; i++)
+    fprintf(stderr, " %s", engine_names[i]);
+  fputs("\n  compares the bins b0 to b1 of the engine (auto: the one it\n"
+      "  chooses) with the ones of the fft, batches of k sequences\n"
+      "  (default 1), 20 batches\n", stderr);
+  exit(1);
+}
+
+static void init(asa_t asa, int s, int n, int b0, int b1, int k, int engine) {
+  *asa = (struct asa_struct_t){
+    .param = {
+      .s = s, .n = n, .m = 1 + n / 2,
+      .b0 = b0, .b1 = b1, .b = 1 + b1 - b0,
+      .p = 1.0, .l = 1 + b1 - b0,
+      .r = 1, .d = s, .w = W_HANN, .e = E_ESTIMATE, .k = k, .t = 1, .c = 1,
+      .engine = engine, .smooth = 1, .join = 1, .rate = 44100,
+    },
+  };
+  asa->param.g = asa_distribute_bins(asa->param.l, asa->param.b, 1.0);
+  const char *error = asa_check_param(&asa->param);
+  if (error) y_error("%s", error);
+  asa_init_fft(asa);
+}
+
+int main(int argc, char **argv) {
+  if (argc < 6 || argc > 7) usage();
+  int s = strtoul(argv[1], NULL, 10), n = strtoul(argv[2], NULL, 10);
+  int b0 = strtoul(argv[3], NULL, 10), b1 = strtoul(argv[4], NULL, 10);
+  if (s < 1 || s > n || n > 65536 || b0 < 1 || b0 > b1 || b1 >= n / 2)
+    usage();
+  int engine;
+  for (engine = X_FIRST; engine <= X_LAST; engine++)
+    if (0 == strcmp(argv[5], engine_names[engine])) break;
+  if (engine > X_LAST) usage();
+  int k = argc == 7 ? strtoul(argv[6], NULL, 10) : 1;
+  if (k < 1 || k > 256) usage();
+
+  struct asa_struct_t fft, band;
+  init(&fft, s, n, b0, b1, k, X_FFT);
+  init(&band, s, n, b0, b1, k, engine);
+
+  const int count = 20, len = count * k * s;
+  int16_t *s16le = malloc(sizeof(int16_t) * len);
+  if (!s16le) y_oom();
+  srand(0);
+  for (int i = 0; i < len; i++)
+    s16le[i] = 8000 * sin(i * 0.3) + 3000 * sin(i * 0.01) + rand() % 2000;
+
+  // Relative to the largest bin of the batch slot
+  double max_error = 0;
+  for (int q = 0; q < count; q++) {
+    for (int j = 0; j < k; j++) {
+      fft.s16le = band.s16le = s16le + (q * k + j) * s;
+      asa_batch_slot(&fft, j);
+      asa_batch_slot(&band, j);
+      asa_pad_and_window(&fft);
+      asa_pad_and_window(&band);
+    }
+    asa_run_fft(&fft);
+    asa_run_fft(&band);
+    for (int j = 0; j < k; j++) {
+      const FFTW(complex) *const c = fft.ck + j * fft.param.m;
+      const FFTW(complex) *const e = band.ck + j * band.param.m;
+      double error = 0, max = 0;
+      for (int i = b0; i <= b1; i++) {
+        max = fmax(max, hypot(c[i][0], c[i][1]));
+        error = fmax(error, hypot(e[i][0] - c[i][0], e[i][1] - c[i][1]));
+      }
+      if (max > 0) max_error = fmax(max_error, error / max);
+    }
+  }
+
+#ifdef ASA_FLOAT
+  const double limit = 1e-4;
+#else
+  const double limit = 1e-9;
+#endif
+  printf("%d %d %d %d %s: %s ", s, n, b0, b1, argv[5],
+    engine_names[band.param.engine]);
+  if (max_error < limit) puts("ok");
+  else printf("error %g\n", max_error);
+
+  free(s16le);
+  free(fft.param.g);
+  free(band.param.g);
+  asa_cleanup(&fft);
+  asa_cleanup(&band);
+}
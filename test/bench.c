@@ -0,0 +1,235 @@
+#include <asa.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+
+#define Y_DBG_MAIN
+#include <y_dbg.h>
+
+#define MAX_LIST 16
+#define PCM_SIZE 65536 // samples of synthetic pcm, sequences wrap around
+
+__attribute__((noreturn))
+static void usage() {
+  fprintf(stderr, "Usage: bench [options]\n"
+      "  runs asa_pad_and_window(), asa_run_fft(), asa_lines() and\n"
+      "  asa_write() (to /dev/null) on synthetic pcm for every combination\n"
+      "  of the swept parameters, lists are separated by commas\n"
+      "  -s samples per sequence               default 256,1024,4096\n"
+      "  -n fft sizes, s for n = s             default s\n"
+      "  -d distances, also in %% of s          default 100%%\n"
+      "  -l lines (at most b)                  default 32\n"
+      "  -p powers                             default 1\n"
+      "  -w windows                            default hann\n"
+      "  -e engines (sdft only with n = s,     default fft\n"
+      "     fixed only with n a power of 2,\n"
+      "     pruned only with n %% 16 == 0,\n"
+      "     padded only with n >= 2 s)\n"
+      "  -k sequences per fft batch            default 1\n"
+      "  -c number of measured sequences       default 2000\n"
+      "  -u number of warmup sequences         default 200\n"
+      "  -f output format: csv or json         default csv\n"
+      "  Per stage and in total: mean, 50th, 90th and 99th percentile of\n"
+      "  ns per sequence (of batches), spectrums per second, pcm input and\n"
+      "  u8 output bytes per second.\n");
+  exit(1);
+}
+
+// Comma separated list of numbers (a trailing % gets -1 * value, see -d and
+// -n) or names (index in names), returns the length
+static int parse_list(char *arg, double *list, const char **names, int num) {
+  int len = 0;
+  for (char *item = strtok(arg, ","); item; item = strtok(NULL, ",")) {
+    if (len == MAX_LIST) usage();
+    if (names) {
+      int i;
+      for (i = 0; i < num; i++) if (0 == strcmp(item, names[i])) break;
+      if (i == num) usage();
+      list[len++] = i;
+      continue;
+    }
+    if (0 == strcmp(item, "s")) { list[len++] = 0; continue; }
+    char *tail;
+    list[len] = strtod(item, &tail);
+    if (tail == item || list[len] <= 0) usage();
+    if (tail[0] == '%') list[len] *= -1;
+    else if (tail[0]) usage();
+    len++;
+  }
+  if (!len) usage();
+  return len;
+}
+
+static double now() {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+static int compare(const void *a, const void *b) {
+  double x = *(const double*)a, y = *(const double*)b;
+  return (x > y) - (x < y);
+}
+
+enum { S_WINDOW, S_FFT, S_LINES, S_WRITE, S_TOTAL, STAGES };
+static const char *bench_stages[] = {
+  "window", "fft", "lines", "write", "total"
+};
+
+static int json = 0, rows = 0;
+
+// One output row for a stage; times are ns per batch of k sequences, sorted
+static void report(asa_param_t *p, int stage, double *times, int num) {
+  double mean = 0;
+  for (int i = 0; i < num; i++) mean += times[i];
+  mean /= num * p->k;
+  double p50 = times[num * 50 / 100] / p->k, p90 = times[num * 90 / 100] / p->k;
+  double p99 = times[num * 99 / 100] / p->k;
+  double per_s = 1e9 / mean;
+
+  const char *fmt = json
+    ? "%s\n  { \"engine\": \"%s\", \"window\": \"%s\", \"s\": %d, \"n\": %d, "
+      "\"d\": %d, \"l\": %d, \"p\": %g, \"k\": %d, \"stage\": \"%s\", "
+      "\"mean_ns\": %.1f, \"p50_ns\": %.1f, \"p90_ns\": %.1f, "
+      "\"p99_ns\": %.1f, \"spectra_per_s\": %.1f, \"in_bytes_per_s\": %.0f, "
+      "\"out_bytes_per_s\": %.0f }"
+    : "%s%s,%s,%d,%d,%d,%d,%g,%d,%s,%.1f,%.1f,%.1f,%.1f,%.1f,%.0f,%.0f\n";
+  printf(fmt, json ? rows ? "," : "[" : "",
+    engine_names[p->engine], window_names[p->w], p->s, p->n, p->d, p->l,
+    p->p, p->k, bench_stages[stage], mean, p50, p90, p99,
+    per_s, per_s * sizeof(int16_t) * p->d, per_s * p->l);
+  rows++;
+}
+
+// Warmup, then count sequences in batches of k, every stage timed per batch
+static void run(asa_param_t p, int count, int warmup, int16_t *pcm) {
+  struct asa_struct_t asa = { .param = p };
+  asa.param.g = asa_distribute_bins(p.l, p.b, p.p);
+  asa.fd_out = open("/dev/null", O_WRONLY);
+  if (asa.fd_out == -1) y_error("open /dev/null: %s", y_strerr);
+  asa_init_fft(&asa);
+  asa_init_output(&asa);
+
+  const int k = p.k, batches = count / k, skip = warmup / k;
+  double *times[STAGES];
+  for (int i = 0; i < STAGES; i++) {
+    times[i] = malloc(sizeof(double) * batches);
+    if (!times[i]) y_oom();
+  }
+
+  long seq = 0;
+  for (int batch = -skip; batch < batches; batch++) {
+    double t[STAGES];
+    t[S_WINDOW] = now();
+    for (int j = 0; j < k; j++, seq++) {
+      asa.s16le = pcm + seq * p.d % PCM_SIZE;
+      asa_batch_slot(&asa, j);
+      asa_pad_and_window(&asa);
+    }
+    t[S_FFT] = now();
+    asa_run_fft(&asa);
+    t[S_LINES] = now();
+    for (int j = 0; j < k; j++) {
+      asa_batch_slot(&asa, j);
+      asa_lines(&asa);
+    }
+    t[S_WRITE] = now();
+    for (int j = 0; j < k; j++) {
+      asa_batch_slot(&asa, j);
+      asa_write(&asa);
+    }
+    t[S_TOTAL] = now();
+    if (batch < 0) continue;
+
+    for (int i = 0; i < S_TOTAL; i++) times[i][batch] = t[i + 1] - t[i];
+    times[S_TOTAL][batch] = t[S_TOTAL] - t[S_WINDOW];
+  }
+
+  for (int i = 0; i < STAGES; i++) {
+    qsort(times[i], batches, sizeof(double), compare);
+    report(&asa.param, i, times[i], batches);
+    free(times[i]);
+  }
+
+  close(asa.fd_out);
+  free(asa.param.g);
+  asa_cleanup(&asa);
+}
+
+int main(int argc, char **argv) {
+  double s[MAX_LIST] = { 256, 1024, 4096 }, n[MAX_LIST] = { 0 };
+  double d[MAX_LIST] = { -100 }, l[MAX_LIST] = { 32 }, p[MAX_LIST] = { 1 };
+  double w[MAX_LIST] = { W_HANN }, e[MAX_LIST] = { X_FFT }, k[MAX_LIST] = { 1 };
+  int num_s = 3, num_n = 1, num_d = 1, num_l = 1, num_p = 1, num_w = 1;
+  int num_e = 1, num_k = 1;
+  int count = 2000, warmup = 200;
+
+  int opt;
+  while (-1 != (opt = getopt(argc, argv, "s:n:d:l:p:w:e:k:c:u:f:"))) {
+    switch (opt) {
+      case 's': num_s = parse_list(optarg, s, NULL, 0); break;
+      case 'n': num_n = parse_list(optarg, n, NULL, 0); break;
+      case 'd': num_d = parse_list(optarg, d, NULL, 0); break;
+      case 'l': num_l = parse_list(optarg, l, NULL, 0); break;
+      case 'p': num_p = parse_list(optarg, p, NULL, 0); break;
+      case 'w': num_w = parse_list(optarg, w, window_names, W_LAST + 1); break;
+      case 'e': num_e = parse_list(optarg, e, engine_names, X_LAST + 1); break;
+      case 'k': num_k = parse_list(optarg, k, NULL, 0); break;
+      case 'c': count = strtoul(optarg, NULL, 10); break;
+      case 'u': warmup = strtoul(optarg, NULL, 10); break;
+      case 'f': {
+        if (0 == strcmp(optarg, "json")) json = 1;
+        else if (strcmp(optarg, "csv")) usage();
+      } break;
+      default: usage();
+    }
+  }
+  if (optind != argc || count < 1) usage();
+
+  int max_s = 0;
+  for (int i = 0; i < num_s; i++) {
+    if (s[i] < 4 || s[i] > x) usage();
+    if (s[i] > max_s) max_s = s[i];
+  }
+  int16_t *pcm = malloc(sizeof(int16_t) * (PCM_SIZE + max_s));
+  if (!pcm) y_oom();
+  srand(0);
+  for (int i = 0; i < PCM_SIZE + max_s; i++) pcm[i] = rand() % 20000 - 10000;
+
+  if (!json) puts("engine,window,s,n,d,l,p,k,stage,mean_ns,p50_ns,p90_ns,"
+    "p99_ns,spectra_per_s,in_bytes_per_s,out_bytes_per_s");
+
+  // Combinations the engines can't do are skipped
+  for (int is = 0; is < num_s; is++)
+  for (int in = 0; in < num_n; in++)
+  for (int id = 0; id < num_d; id++)
+  for (int il = 0; il < num_l; il++)
+  for (int ip = 0; ip < num_p; ip++)
+  for (int iw = 0; iw < num_w; iw++)
+  for (int ie = 0; ie < num_e; ie++)
+  for (int ik = 0; ik < num_k; ik++) {
+    asa_param_t a = {
+      .s = s[is], .n = n[in] ? n[in] : s[is],
+      .d = d[id] < 0 ? -d[id] / 100 * s[is] : d[id],
+      .p = p[ip], .r = 1, .w = w[iw], .e = E_ESTIMATE,
+      .k = k[ik], .t = 1, .c = 1, .engine = e[ie], .join = 1,
+    };
+    a.m = 1 + a.n / 2;
+    a.b0 = 1, a.b1 = a.m - 2, a.b = 1 + a.b1 - a.b0;
+    a.l = min((int)l[il], a.b);
+    if (a.n < a.s || a.n > x || a.d < 1 || a.k < 1 || a.k > 256) continue;
+    if (a.p < 1 || a.p > 2 || (a.p > 1 && a.l == a.b)) continue;
+    if (a.engine == X_SDFT && (a.n != a.s || a.k > 1)) continue;
+    if (a.engine == X_FIXED && (a.n & (a.n - 1) || a.n > 32768 || a.k > 1))
+      continue;
+    if (a.engine == X_PRUNED && a.n % 16) continue;
+    if (a.engine == X_PADDED && (a.n < 2 * a.s || a.n % 2)) continue;
+
+    run(a, count, warmup, pcm);
+  }
+
+  if (json) puts(rows ? "\n]" : "[]");
+  free(pcm);
+}
@@ -0,0 +1,68 @@
+#include <asa.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define Y_DBG_MAIN
+#include <y_dbg.h>
+
+__attribute__((noreturn))
+static void usage() {
+  fprintf(stderr, "Usage: cq <s> <n> <b0> <l> <window>\n"
+      "  where: 4 <= s <= n <= 65536; 1 <= b0 < n / 2; 1 <= l <= n / 2;\n"
+      "  window one of:");
+  for (int i = 0; i <= W_LAST; i++)
+    fprintf(stderr, " %s", window_names[i]);
+  fputs("\n  for a sine at the center frequency of every constant-Q line over\n"
+      "  bins b0 to n / 2 - 1 prints the line with the largest magnitude (.\n"
+      "  if it is the line of the sine)\n", stderr);
+  exit(1);
+}
+
+int main(int argc, char **argv) {
+  if (argc != 6) usage();
+  int s = strtoul(argv[1], NULL, 10);
+  int n = strtoul(argv[2], NULL, 10);
+  if (s < 4 || n < s || n > 65536) usage();
+  int b0 = strtoul(argv[3], NULL, 10);
+  if (b0 < 1 || b0 >= n / 2) usage();
+  int l = strtoul(argv[4], NULL, 10);
+  if (l < 1 || l > n / 2) usage();
+  int w;
+  for (w = W_FIRST; w <= W_LAST; w++)
+    if (0 == strcmp(argv[5], window_names[w])) break;
+  if (w > W_LAST) usage();
+
+  struct asa_struct_t asa = {
+    .param = {
+      .s = s, .n = n, .m = 1 + n / 2,
+      .b0 = b0, .b1 = n / 2 - 1, .b = n / 2 - b0,
+      .p = 1.0, .l = l, .q = 1,
+      .r = 1, .d = s, .w = w, .e = E_ESTIMATE, .k = 1, .t = 1, .c = 1,
+    },
+  };
+  asa_init_fft(&asa);
+
+  // Center frequencies like asa_init_cq()
+  const double e0 = b0 - 0.5, ratio = pow((n / 2 - 0.5) / e0, 1.0 / l);
+  int16_t s16le[s];
+  printf("%d %d %d %d %s:", s, n, b0, l, window_names[w]);
+  for (int i = 0; i < l; i++) {
+    double f = e0 * pow(ratio, i + 0.5);
+    for (int t = 0; t < s; t++)
+      s16le[t] = 10000 * sin(2 * M_PI * f * (t + (n - s) / 2) / n);
+    asa.s16le = s16le;
+    asa_batch_slot(&asa, 0);
+    asa_pad_and_window(&asa);
+    asa_run_fft(&asa);
+    asa_lines(&asa);
+
+    int top = 0;
+    for (int j = 1; j < l; j++) if (asa.d[j] > asa.d[top]) top = j;
+    if (top == i) printf(" .");
+    else printf(" %d", top);
+  }
+  puts("");
+
+  asa_cleanup(&asa);
+}
@@ -0,0 +1,67 @@
+#include <asa.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define Y_DBG_MAIN
+#include <y_dbg.h>
+
+__attribute__((noreturn))
+static void usage() {
+  fputs("Usage: decim <D> <s> <d> <f>\n"
+      "  where: 2 <= D <= 64; 1 <= d <= s <= 4096; 0 < f < D\n"
+      "  decimates a sine of f times the new Nyquist frequency by D in\n"
+      "  sequences of s frames at a distance of d, prints the gain in dB\n"
+      "  and whether the overlapping sequences match the ones decimated\n"
+      "  from scratch\n", stderr);
+  exit(1);
+}
+
+static void init(asa_t asa, int D, int s, int d) {
+  *asa = (struct asa_struct_t){
+    .param = { .s = s, .d = d, .c = 1, .decim = D },
+  };
+  asa_init_decim(asa);
+}
+
+int main(int argc, char **argv) {
+  if (argc != 5) usage();
+  int D = strtoul(argv[1], NULL, 10), s = strtoul(argv[2], NULL, 10);
+  int d = strtoul(argv[3], NULL, 10);
+  double f = strtod(argv[4], NULL);
+  if (D < 2 || D > 64 || s < 1 || s > 4096 || d < 1 || d > s || f <= 0
+    || f >= D) usage();
+
+  struct asa_struct_t overlap, scratch;
+  init(&overlap, D, s, d);
+  init(&scratch, D, s, d);
+
+  const int count = 20, in = asa_in_frames(&overlap.param);
+  const int len = (count - 1) * d * D + in;
+  int16_t *s16le = malloc(sizeof(int16_t) * len);
+  if (!s16le) y_oom();
+  for (int i = 0; i < len; i++) s16le[i] = lrint(16000 * sin(M_PI * f / D * i));
+
+  // The scratch one forgets the previous sequence
+  double power = 0;
+  int same = 1;
+  for (int q = 0; q < count; q++) {
+    overlap.s16le = scratch.s16le = s16le + q * d * D;
+    scratch.gap = 1;
+    asa_decimate(&overlap);
+    asa_decimate(&scratch);
+    if (memcmp(overlap.s16le, scratch.s16le, sizeof(int16_t) * s)) same = 0;
+    for (int i = 0; i < s; i++)
+      power += (double)overlap.s16le[i] * overlap.s16le[i];
+  }
+  const double gain = 10 * log10(fmax(power / count / s, 1e-3) / (16000. *
+    16000 / 2));
+
+  printf("%d %d %d %g: %s, overlap %s\n", D, s, d, f,
+    gain > -0.1 ? "passband" : gain < -60 ? "stopband" : "transition",
+    same ? "ok" : "differs");
+
+  free(s16le);
+  asa_free_decim(&overlap);
+  asa_free_decim(&scratch);
+}
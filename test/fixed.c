@@ -0,0 +1,94 @@
+#include <asa.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define Y_DBG_MAIN
+#include <y_dbg.h>
+
+__attribute__((noreturn))
+static void usage() {
+  fprintf(stderr, "Usage: fixed <s> <n> <l> <window> [amplitude]\n"
+      "  where: 1 <= s <= n; n a power of 2, 16 <= n <= 32768; 1 <= l <= b;\n"
+      "  window one of:");
+  for (int i = 0; i <= W_LAST; i++)
+    fprintf(stderr, " %s", window_names[i]);
+  fputs("\n  compares the lines of the fixed-point engine with the ones of\n"
+      "  the fft engine on two sines and noise (default amplitude 10000,\n"
+      "  at most 32767), 100 sequences\n", stderr);
+  exit(1);
+}
+
+static void init(asa_t asa, int s, int n, int l, int w, int engine) {
+  *asa = (struct asa_struct_t){
+    .param = {
+      .s = s, .n = n, .m = 1 + n / 2,
+      .b0 = 1, .b1 = n / 2 - 1, .b = n / 2 - 1,
+      .p = 1.0, .l = l,
+      .r = 1, .d = s, .w = w, .e = E_ESTIMATE, .k = 1, .t = 1, .c = 1,
+      .engine = engine, .smooth = 1, .join = 1, .rate = 44100,
+    },
+  };
+  asa->param.g = asa_distribute_bins(l, asa->param.b, asa->param.p);
+  const char *error = asa_check_param(&asa->param);
+  if (error) y_error("%s", error);
+  asa_init_fft(asa);
+}
+
+static void lines(asa_t asa, int16_t *s16le) {
+  asa->s16le = s16le;
+  asa_batch_slot(asa, 0);
+  asa->chan = 0;
+  asa_pad_and_window(asa);
+  asa_run_fft(asa);
+  asa_lines(asa);
+}
+
+int main(int argc, char **argv) {
+  if (argc < 5 || argc > 6) usage();
+  int s = strtoul(argv[1], NULL, 10), n = strtoul(argv[2], NULL, 10);
+  int l = strtoul(argv[3], NULL, 10);
+  if (s < 1 || s > n || n < 16 || n > 32768 || l < 1 || l > n / 2 - 1)
+    usage();
+  int w;
+  for (w = W_FIRST; w <= W_LAST; w++)
+    if (0 == strcmp(argv[4], window_names[w])) break;
+  if (w > W_LAST) usage();
+  int amplitude = argc == 6 ? strtoul(argv[5], NULL, 10) : 10000;
+  if (amplitude < 10 || amplitude > 32767) usage();
+
+  struct asa_struct_t fft, fixed;
+  init(&fft, s, n, l, w, X_FFT);
+  init(&fixed, s, n, l, w, X_FIXED);
+
+  const int count = 100, len = count * s;
+  int16_t *s16le = malloc(sizeof(int16_t) * len);
+  if (!s16le) y_oom();
+  srand(0);
+  for (int i = 0; i < len; i++)
+    s16le[i] = 0.7 * amplitude * sin(i * 0.3)
+      + 0.2 * amplitude * sin(i * 1.7) + rand() % (amplitude / 10);
+
+  // Relative to the largest line: the magnitudes are approximated (-3% to
+  // +0.8%), quantization adds a little
+  double max_error = 0;
+  for (int q = 0; q < count; q++) {
+    lines(&fft, s16le + q * s);
+    lines(&fixed, s16le + q * s);
+    double error = 0;
+    for (int i = 0; i < l; i++)
+      error = fmax(error, fabs(fixed.d[i] - fft.d[i]));
+    if (fft.max_mag > 0) max_error = fmax(max_error, error / fft.max_mag);
+  }
+
+  printf("%d %d %d %s %d: ", s, n, l, window_names[w], amplitude);
+  if (max_error < 0.035) puts("ok");
+  else printf("error %g\n", max_error);
+  y_dbg("max error %g", max_error);
+
+  free(s16le);
+  free(fft.param.g);
+  free(fixed.param.g);
+  asa_cleanup(&fft);
+  asa_cleanup(&fixed);
+}
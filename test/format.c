@@ -0,0 +1,104 @@
+#include <asa.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define Y_DBG_MAIN
+#include <y_dbg.h>
+
+#define MAX_L 64
+
+__attribute__((noreturn))
+static void usage() {
+  fprintf(stderr, "Usage: format <format> <j> <lines>...\n"
+      "       format <format> 0 <l>\n"
+      "  where: format one of:");
+  for (int i = 0; i <= O_LAST; i++) fprintf(stderr, " %s", format_names[i]);
+  fputs("; 1 <= j <= 256;\n"
+      "  lines are comma separated u8 values of a spectrum (at most 64),\n"
+      "  prints in hex what is written: the header, then for every spectrum\n"
+      "  the bytes written (- if buffered), at last the bytes of the flush;\n"
+      "  with j 0 prints whether the format takes l lines of an fft of\n"
+      "  2^20 samples (1 <= l <= 2^19)\n",
+      stderr);
+  exit(1);
+}
+
+// New bytes of the output file in hex, - if there are none
+static void print_new(int fd) {
+  static off_t done = 0;
+  static int calls = 0;
+  uint8_t c;
+  int num = 0;
+  if (calls++) printf(" ");
+  while (pread(fd, &c, 1, done + num) == 1) printf("%02x", c), num++;
+  if (!num) printf("-");
+  done += num;
+}
+
+// The parameters of auspan -o format -s 2^20 -l l
+static void check(int format, int l) {
+  const int n = 1 << 20;
+  const asa_param_t p = {
+    .s = n, .n = n, .m = 1 + n / 2, .b0 = 1, .b1 = n / 2, .b = n / 2,
+    .p = 1.0, .l = l, .r = 1, .d = n, .rate = 44100, .decim = 1,
+    .w = W_HANN, .e = E_ESTIMATE, .k = 1, .t = 1, .c = 1,
+    .engine = X_GOERTZEL, // of every build, also make FIXED=1
+    .smooth = 1, .format = format, .floor = -48, .join = 1,
+  };
+  const char *error = asa_check_param(&p);
+  printf("%s %d: %s\n", format_names[format], l, error ? error : "ok");
+}
+
+int main(int argc, char **argv) {
+  if (argc < 4) usage();
+  int format;
+  for (format = O_FIRST; format <= O_LAST; format++)
+    if (0 == strcmp(argv[1], format_names[format])) break;
+  if (format > O_LAST) usage();
+  int join = strtoul(argv[2], NULL, 10);
+  if (join == 0 && argc == 4) {
+    int l = strtoul(argv[3], NULL, 10);
+    if (l < 1 || l > 1 << 19) usage();
+    check(format, l);
+    return 0;
+  }
+  if (join < 1 || join > 256) usage();
+
+  asa_real_t d[MAX_L];
+  int l = 0;
+  for (char *v = strtok(argv[3], ","); v; v = strtok(NULL, ",")) {
+    if (l == MAX_L) usage();
+    d[l++] = strtoul(v, NULL, 10);
+  }
+
+  FILE *file = tmpfile();
+  if (!file) y_error("tmpfile: %s", y_strerr);
+  struct asa_struct_t asa = {
+    .param = {
+      .l = l, .c = 1, .d = 1, .r = 1, .b0 = 1, .b1 = 1,
+      .smooth = 1, .format = format, .floor = -48, .join = join,
+    },
+    .fd_out = fileno(file), .d = d, .max_mag = 255,
+  };
+  asa_init_output(&asa);
+  print_new(asa.fd_out);
+
+  for (int i = 3; i < argc; i++) {
+    if (i > 3) {
+      int j = 0;
+      for (char *v = strtok(argv[i], ","); v; v = strtok(NULL, ","))
+        if (j < l) d[j++] = strtoul(v, NULL, 10);
+      if (j != l) usage();
+    }
+    asa_write(&asa);
+    print_new(asa.fd_out);
+  }
+  asa_flush(&asa);
+  print_new(asa.fd_out);
+  puts("");
+
+  fclose(file);
+  free(asa.out);
+  free(asa.prev);
+}
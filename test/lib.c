@@ -0,0 +1,115 @@
+#include <auspan.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+
+// Only the library API of auspan.h, like an application embedding auspan
+
+#define FRAMES 100000
+
+__attribute__((noreturn))
+static void usage() {
+  fprintf(stderr, "Usage: lib <s> <d> <c> <threads>\n"
+      "  where: 1024 <= s <= 65536; 1 <= d; 1 <= c <= 2; 1 <= threads <= 16\n"
+      "  analyses sines at the centers of line 2 (and 5 for channel 1) of 7\n"
+      "  lines of 73 bins each: the frames at once and in chunks of random\n"
+      "  size give the same spectrums, the line of the sine is the largest;\n"
+      "  then analysers on threads give the same spectrums\n");
+  exit(1);
+}
+
+static int s, d, c;
+static int16_t *pcm;
+
+typedef struct run_t {
+  int chunks;             // in chunks of random size
+  float *lines;           // the spectrums
+  int num;                // their number
+} run_t;
+
+static void *run(void *arg) {
+  run_t *const r = arg;
+  auspan_config_t config;
+  auspan_config(&config, s);
+  config.d = d, config.c = c, config.l = 7, config.b1 = 7 * 73;
+
+  const char *error;
+  auspan_t a = auspan_new(&config, &error);
+  if (!a) { fprintf(stderr, "auspan_new: %s\n", error); exit(1); }
+  const int l = auspan_lines(a), max = FRAMES / d * c + c;
+  r->lines = malloc(sizeof(float) * l * max);
+  if (!r->lines) exit(1);
+
+  unsigned seed = 1;
+  size_t done = 0;
+  r->num = 0;
+  while (done < FRAMES) {
+    size_t frames = FRAMES - done;
+    if (r->chunks && frames > 3000) frames = 1 + rand_r(&seed) % 3000;
+    int limit = r->chunks ? c * (1 + rand_r(&seed) % 4) : max - r->num, num;
+    done += auspan_process(a, pcm + done * c, frames,
+      r->lines + r->num * l, limit, &num);
+    r->num += num;
+  }
+  auspan_free(a);
+  return NULL;
+}
+
+int main(int argc, char **argv) {
+  if (argc != 5) usage();
+  s = strtoul(argv[1], NULL, 10), d = strtoul(argv[2], NULL, 10);
+  c = strtoul(argv[3], NULL, 10);
+  int threads = strtoul(argv[4], NULL, 10);
+  if (s < 1024 || s > 65536 || d < 1 || c < 1 || c > 2) usage();
+  if (threads < 1 || threads > 16) usage();
+
+  // Channel j at the center bin of line 2 + 3 j: 1 + 73 (2 + 3 j) + 36
+  pcm = malloc(sizeof(*pcm) * FRAMES * c);
+  if (!pcm) exit(1);
+  for (int i = 0; i < FRAMES; i++)
+    for (int j = 0; j < c; j++)
+      pcm[i * c + j] = 10000 * sin(2 * M_PI * (37 + 73 * (2 + 3 * j)) * i / s)
+        + rand() % 100;
+
+  auspan_config_t config;
+  auspan_config(&config, s);
+  config.l = s; // more lines than bins
+  const char *error = NULL;
+  printf("%d %d %d %d: %s", s, d, c, threads,
+    auspan_new(&config, &error) ? "" : error);
+
+  run_t once = { 0 }, chunks = { 1 };
+  run(&once);
+  run(&chunks);
+  int ok = once.num == chunks.num && !memcmp(once.lines, chunks.lines,
+    sizeof(float) * 7 * once.num);
+
+  // The largest line of channel j is 2 + 3 j
+  for (int i = 0; i < once.num; i++) {
+    const float *lines = once.lines + i * 7;
+    int top = 0;
+    for (int k = 1; k < 7; k++) if (lines[k] > lines[top]) top = k;
+    if (top != 2 + 3 * (i % c)) ok = 0;
+  }
+
+  pthread_t thread[threads];
+  run_t runs[threads];
+  for (int i = 0; i < threads; i++) {
+    runs[i] = (run_t){ i % 2 };
+    if (pthread_create(thread + i, NULL, run, runs + i)) exit(1);
+  }
+  for (int i = 0; i < threads; i++) {
+    pthread_join(thread[i], NULL);
+    if (runs[i].num != once.num || memcmp(runs[i].lines, once.lines,
+        sizeof(float) * 7 * once.num))
+      ok = 0;
+    free(runs[i].lines);
+  }
+
+  printf(", %d spectrums, %s\n", once.num, ok ? "ok" : "wrong");
+  free(once.lines);
+  free(chunks.lines);
+  free(pcm);
+}
@@ -0,0 +1,76 @@
+#include <asa.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define Y_DBG_MAIN
+#include <y_dbg.h>
+
+#define N 4096
+
+__attribute__((noreturn))
+static void usage() {
+  fputs("Usage: lines <b0> <b1> <l> <p>\n"
+      "  where: 0 <= b0 <= b1 <= 2048; 1 <= l <= b1 - b0 + 1; 1 <= p <= 2\n"
+      "  combines random bins b0 to b1 of an fft of 4096 samples to l lines\n"
+      "  with asa_lines() (the magnitude kernel of the cpu) and compares\n"
+      "  them, their maximum and the -1 after them with a scalar reference\n",
+      stderr);
+  exit(1);
+}
+
+int main(int argc, char **argv) {
+  if (argc != 5) usage();
+  int b0 = strtoul(argv[1], NULL, 10), b1 = strtoul(argv[2], NULL, 10);
+  int l = strtoul(argv[3], NULL, 10);
+  double p = strtod(argv[4], NULL);
+  if (b0 > b1 || b1 > N / 2 || l < 1 || l > b1 - b0 + 1 || p < 1 || p > 2)
+    usage();
+
+  struct asa_struct_t asa = {
+    .param = {
+      .s = N, .n = N, .m = 1 + N / 2, .b0 = b0, .b1 = b1, .b = 1 + b1 - b0,
+      .p = p, .l = l, .r = 1, .d = N, .c = 1, .smooth = 1, .join = 1,
+    },
+  };
+  asa.param.g = asa_distribute_bins(l, asa.param.b, p);
+  asa.c = FFTW(alloc_complex)(asa.param.m);
+  asa.d = malloc(sizeof(*asa.d) * N);
+  if (!asa.c || !asa.d) y_oom();
+  asa_init_lines(&asa);
+
+  srand(0);
+  for (int k = 0; k < asa.param.m; k++) {
+    asa.c[k][0] = rand() % 20001 - 10000;
+    asa.c[k][1] = rand() % 20001 - 10000;
+  }
+  asa_lines(&asa);
+
+  // Line i has the g[i] bins after the ones of the lines before
+  double max_error = 0, max_mag = 0;
+  for (int i = 0, k = b0; i < l; i++) {
+    double sum = 0;
+    for (int j = 0; j < asa.param.g[i]; j++, k++)
+      sum += hypot(asa.c[k][0], asa.c[k][1]);
+    const double line = sum / asa.param.g[i];
+    max_error = fmax(max_error, fabs(asa.d[i] - line) / line);
+    max_mag = fmax(max_mag, line);
+  }
+
+#ifdef ASA_FLOAT
+  const double limit = 1e-5;
+#else
+  const double limit = 1e-12;
+#endif
+  printf("%d %d %d %g: ", b0, b1, l, p);
+  if (max_error >= limit) printf("error %g\n", max_error);
+  else if (fabs(asa.max_mag - max_mag) >= limit * max_mag)
+    printf("maximum %g, not %g\n", asa.max_mag, max_mag);
+  else if (asa.d[l] != -1) printf("no -1 after the lines\n");
+  else puts("ok");
+
+  free(asa.param.g);
+  free(asa.rg);
+  free(asa.d);
+  FFTW(free)(asa.c);
+}
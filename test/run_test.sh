@@ -49,6 +49,8 @@ power 103 11 1
 103 11 1: 9 9 10 9 10 9 10 9 10 9 9 103
 power 104 11 1
 104 11 1: 9 10 9 10 9 10 9 10 9 10 9 104
+power 58 10 1
+58 10 1: 5 6 6 6 6 6 6 6 6 5 58
 power 1 1 1
 1 1 1: 1 1
 power 10 1 1
@@ -61,22 +63,146 @@ power 1000 10 1.001
 1000 10 1.001: 100 100 100 100 100 100 100 100 100 100 1000
 power 1000 10 1.01
 1000 10 1.01: 96 97 98 98 99 100 101 102 104 105 1000
+power 1000 10 1.05
+1000 10 1.05: 80 83 88 92 97 101 107 112 117 123 1000
 power 1000 10 1.1
 1000 10 1.1: 63 69 76 84 92 101 111 122 134 148 1000
 power 1000 10 1.5
-1000 10 1.5: 9 14 20 30 45 67 99 151 226 339 1000
+1000 10 1.5: 9 13 20 30 45 67 100 151 226 339 1000
 power 1000 10 2
-1000 10 2: 1 2 4 8 16 32 63 125 250 499 1000
+1000 10 2: 1 2 4 8 16 31 63 125 250 500 1000
 power 1000000 100 1.5
-1000000 100 1.5: 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 2 2 3 4 6 9 14 20 30 45 67 101 151 226 339 508 761 1142 1713 2569 3854 5781 8671 13006 19509 29264 43896 65844 98692 148148 222222 333333 1000000
+1000000 100 1.5: 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 2 3 4 6 9 13 20 30 45 67 100 150 226 338 507 761 1142 1713 2569 3853 5780 8670 13005 19508 29262 43893 65839 98759 148138 222208 333311 1000000
 power 1000000 100 2
-1000000 100 2: 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 2 4 8 16 31 62 123 244 489 977 1953 3906 7729 15625 31250 62500 125000 250000 500000 1000000
+1000000 100 2: 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 2 4 8 15 31 61 122 244 488 976 1953 3906 7812 15624 31248 62495 124990 249980 499960 1000000
 power 1000000 1000 1.1
-1000000 1000 1.1: 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 2 2 2 2 2 2 2 3 3 3 3 4 4 4 5 5 5 6 6 7 8 8 9 10 11 12 13 15 16 18 19 21 23 26 28 31 34 37 41 45 49 54 60 65 72 79 87 96 105 116 127 140 154 169 186 204 225 247 272 299 329 362 398 438 481 529 582 640 704 775 852 937 1031 1134 1247 1372 1509 1660 1826 2009 2210 2431 2674 2941 3235 3559 3914 4306 4736 5210 5731 6304 6934 7628 8391 9230 10153 11168 12285 13513 14864 16351 17986 19785 21763 23939 26333 28966 31863 35049 38554 42410 46651 51316 56447 62092 68301 74225 82645 90909 1000000
+1000000 1000 1.1: 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 2 2 2 2 2 3 3 3 3 4 4 5 5 5 6 7 7 8 9 10 11 12 13 14 16 17 19 21 23 25 28 30 33 37 40 44 49 54 59 65 71 79 86 95 105 115 127 139 153 168 185 204 224 247 271 298 328 361 397 437 480 529 581 640 703 774 851 936 1030 1133 1246 1371 1508 1659 1824 2007 2208 2428 2671 2938 3232 3555 3911 4302 4732 5205 5726 6299 6928 7621 8383 9222 10144 11158 12274 13501 14851 16337 17970 19767 21744 23918 26310 28941 31835 35019 38521 42373 46610 51271 56398 62038 68242 75066 82573 90830 1000000
 power 1000000 1000 1.01
-1000000 1000 1.01: 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 5 5 5 5 5 5 5 5 5 5 5 5 5 5 5 5 5 5 5 5 5 5 5 6 6 6 6 6 6 6 6 6 6 6 6 6 6 6 6 6 6 7 7 7 7 7 7 7 7 7 7 7 7 7 7 7 8 8 8 8 8 8 8 8 8 8 8 8 8 8 9 9 9 9 9 9 9 9 9 9 9 9 10 10 10 10 10 10 10 10 10 10 11 11 11 11 11 11 11 11 11 11 12 12 12 12 12 12 12 12 12 13 13 13 13 13 13 13 13 14 14 14 14 14 14 14 15 15 15 15 15 15 15 16 16 16 16 16 16 16 17 17 17 17 17 17 18 18 18 18 18 19 19 19 19 19 19 20 20 20 20 20 21 21 21 21 21 22 22 22 22 22 23 23 23 23 24 24 24 24 25 25 25 25 26 26 26 26 27 27 27 27 28 28 28 28 29 29 29 30 30 30 30 31 31 31 32 32 32 33 33 33 34 34 34 35 35 35 36 36 36 37 37 37 38 38 39 39 39 40 40 40 41 41 42 42 43 43 43 44 44 45 45 46 46 46 47 47 48 48 49 49 50 50 51 51 52 52 53 53 54 54 55 55 56 57 57 58 58 59 59 60 61 61 62 62 63 64 64 65 66 66 67 68 68 69 70 70 71 72 72 73 74 75 75 76 77 78 78 79 80 81 81 82 83 84 85 86 86 87 88 89 90 91 92 93 94 94 95 96 97 98 99 100 101 102 103 104 105 106 107 109 110 111 112 113 114 115 116 117 119 120 121 122 123 125 126 127 128 130 131 132 134 135 136 138 139 140 142 143 145 146 148 149 150 152 153 155 157 158 160 161 163 165 166 168 169 171 173 175 176 178 180 182 183 185 187 189 191 193 195 197 199 201 203 205 207 209 211 213 215 217 219 222 224 226 228 231 233 235 238 240 242 245 247 250 252 255 257 260 262 265 268 270 273 276 278 281 284 287 290 293 296 299 301 305 308 311 314 317 320 323 326 330 333 336 340 343 347 350 353 357 361 364 368 371 375 379 383 387 390 394 398 402 406 410 414 419 423 427 431 436 440 444 449 453 458 462 467 472 476 481 486 491 496 501 506 511 516 521 526 531 537 542 547 553 558 564 570 575 581 587 593 599 605 611 617 623 629 636 642 648 655 661 668 675 681 688 695 702 709 716 723 730 738 745 753 760 768 775 783 791 799 807 815 823 831 840 848 856 865 874 882 891 900 909 918 927 937 946 956 965 975 984 994 1004 1014 1024 1035 1045 1055 1066 1077 1087 1098 1109 1120 1132 1143 1154 1166 1178 1189 1201 1213 1225 1238 1250 1262 1275 1288 1301 1314 1327 1340 1354 1367 1381 1395 1408 1423 1437 1451 1466 1480 1495 1510 1525 1540 1556 1571 1587 1603 1619 1635 1651 1668 1685 1702 1719 1736 1753 1771 1788 1806 1824 1842 1861 1880 1898 1917 1936 1956 1975 1995 2015 2035 2056 2076 2097 2118 2139 2160 2182 2204 2226 2248 2271 2293 2316 2339 2363 2386 2410 2434 2459 2483 2508 2533 2559 2584 2610 2636 2662 2689 2716 2743 2771 2798 2826 2855 2883 2912 2941 2970 3000 3030 3060 3091 3122 3153 3185 3217 3249 3281 3314 3347 3381 3414 3449 3483 3518 3553 3589 3624 3661 3697 3734 3772 3809 3847 3886 3925 3964 4004 4044 4084 4125 4166 4208 4250 4292 4335 4379 4423 4467 4511 4557 4602 4648 4695 4742 4789 4837 4885 4934 4983 5033 5084 5134 5186 5238 5290 5343 5396 5450 5505 5560 5615 5672 5728 5786 5843 5902 5961 6020 6081 6141 6203 6265 6328 6391 6455 6519 6253 6650 6717 6784 6852 6920 6990 7059 7130 7201 7273 7346 7420 7494 7569 7644 7721 7798 7876 7955 8034 8115 8196 8278 8361 8444 8529 8614 8700 8787 8875 8964 9053 9144 9235 9328 9421 9515 9610 9706 9803 9901 1000000
+1000000 1000 1.01: 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 5 5 5 5 5 5 5 5 5 5 5 5 5 5 5 5 5 5 5 5 6 6 6 6 6 6 6 6 6 6 6 6 6 6 6 6 6 7 7 7 7 7 7 7 7 7 7 7 7 7 7 8 8 8 8 8 8 8 8 8 8 8 8 8 9 9 9 9 9 9 9 9 9 9 9 10 10 10 10 10 10 10 10 10 10 11 11 11 11 11 11 11 11 11 12 12 12 12 12 12 12 12 12 13 13 13 13 13 13 13 14 14 14 14 14 14 14 14 15 15 15 15 15 15 16 16 16 16 16 16 17 17 17 17 17 17 18 18 18 18 18 18 19 19 19 19 19 20 20 20 20 20 21 21 21 21 21 22 22 22 22 22 23 23 23 23 24 24 24 24 25 25 25 25 26 26 26 26 27 27 27 27 28 28 28 29 29 29 29 30 30 30 31 31 31 31 32 32 32 33 33 33 34 34 34 35 35 35 36 36 37 37 37 38 38 38 39 39 40 40 40 41 41 42 42 42 43 43 44 44 45 45 45 46 46 47 47 48 48 49 49 50 50 51 51 52 52 53 53 54 54 55 56 56 57 57 58 58 59 60 60 61 61 62 63 63 64 64 65 66 66 67 68 68 69 70 70 71 72 73 73 74 75 76 76 77 78 79 79 80 81 82 83 83 84 85 86 87 88 89 89 90 91 92 93 94 95 96 97 98 99 100 101 102 103 104 105 106 107 108 109 110 111 112 114 115 116 117 118 119 121 122 123 124 126 127 128 129 131 132 133 135 136 137 139 140 141 143 144 146 147 149 150 152 153 155 156 158 159 161 163 164 166 167 169 171 173 174 176 178 180 181 183 185 187 189 191 193 194 196 198 200 202 204 206 208 211 213 215 217 219 221 224 226 228 230 233 235 237 240 242 244 247 249 252 254 257 259 262 265 267 270 273 275 278 281 284 287 289 292 295 298 301 304 307 310 313 317 320 323 326 329 333 336 339 343 346 350 353 357 360 364 368 371 375 379 382 386 390 394 398 402 406 410 414 418 423 427 431 435 440 444 448 453 458 462 467 471 476 481 486 491 495 500 505 510 516 521 526 531 536 542 547 553 558 564 569 575 581 587 593 599 604 611 617 623 629 635 642 648 655 661 668 674 681 688 695 702 709 716 723 730 738 745 752 760 768 775 783 791 799 807 815 823 831 839 848 856 865 874 882 891 900 909 918 927 937 946 955 965 975 984 994 1004 1014 1024 1035 1045 1055 1066 1077 1087 1098 1109 1120 1131 1143 1154 1166 1177 1189 1201 1213 1225 1237 1250 1262 1275 1288 1301 1314 1327 1340 1353 1367 1381 1394 1408 1422 1437 1451 1466 1480 1495 1510 1525 1540 1556 1571 1587 1603 1619 1635 1651 1668 1685 1701 1718 1736 1753 1771 1788 1806 1824 1842 1861 1879 1898 1917 1936 1956 1975 1995 2015 2035 2055 2076 2097 2118 2139 2160 2182 2204 2226 2248 2271 2293 2316 2339 2363 2386 2410 2434 2459 2483 2508 2533 2559 2584 2610 2636 2662 2689 2716 2743 2770 2798 2826 2854 2883 2912 2941 2970 3000 3030 3060 3091 3122 3153 3185 3216 3249 3281 3314 3347 3381 3414 3448 3483 3518 3553 3588 3624 3661 3697 3734 3772 3809 3847 3886 3925 3964 4004 4044 4084 4125 4166 4208 4250 4292 4335 4379 4422 4467 4511 4556 4602 4648 4694 4741 4789 4837 4885 4934 4983 5033 5083 5134 5186 5237 5290 5343 5396 5450 5505 5560 5615 5671 5728 5785 5843 5902 5961 6020 6081 6141 6203 6265 6327 6391 6455 6519 6584 6650 6717 6784 6852 6920 6989 7059 7130 7201 7273 7346 7419 7494 7569 7644 7721 7798 7876 7955 8034 8115 8196 8278 8360 8444 8528 8614 8700 8787 8875 8963 9053 9144 9235 9327 9421 9515 9610 9706 9803 9901 1000000
 power 1000000 2000 1.01
-1000000 2000 1.01: 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 5 5 5 5 5 5 5 5 5 5 5 5 5 5 5 5 5 5 5 5 5 5 5 6 6 6 6 6 6 6 6 6 6 6 6 6 6 6 6 6 6 7 7 7 7 7 7 7 7 7 7 7 7 7 7 7 8 8 8 8 8 8 8 8 8 8 8 8 8 8 9 9 9 9 9 9 9 9 9 9 9 9 10 10 10 10 10 10 10 10 10 10 11 11 11 11 11 11 11 11 11 11 12 12 12 12 12 12 12 12 12 13 13 13 13 13 13 13 13 14 14 14 14 14 14 14 15 15 15 15 15 15 15 16 16 16 16 16 16 16 17 17 17 17 17 17 18 18 18 18 18 19 19 19 19 19 19 20 20 20 20 20 21 21 21 21 21 22 22 22 22 22 23 23 23 23 24 24 24 24 25 25 25 25 26 26 26 26 27 27 27 27 28 28 28 28 29 29 29 30 30 30 30 31 31 31 32 32 32 33 33 33 34 34 34 35 35 35 36 36 36 37 37 37 38 38 39 39 39 40 40 40 41 41 42 42 42 43 43 44 44 45 45 46 46 46 47 47 48 48 49 49 50 50 51 51 52 52 53 53 54 54 55 55 56 57 57 58 58 59 59 60 61 61 62 62 63 64 64 65 66 66 67 68 68 69 70 70 71 72 72 73 74 75 75 76 77 78 78 79 80 81 81 82 83 84 85 86 86 87 88 89 90 91 92 93 94 95 95 96 97 98 99 100 101 102 103 104 105 106 107 109 110 111 112 113 114 115 116 117 119 120 121 122 123 125 126 127 128 130 131 132 134 135 136 138 139 140 142 143 145 146 148 149 150 152 154 155 157 158 160 161 163 165 166 168 170 171 173 175 176 178 180 182 184 185 187 189 191 193 195 197 199 201 203 205 207 209 211 213 215 217 219 222 224 226 228 231 233 235 238 240 242 245 247 250 252 255 257 260 262 265 268 270 273 276 278 281 284 287 290 293 296 299 302 305 308 311 314 317 320 323 326 330 333 336 340 343 347 350 353 357 361 364 368 371 375 379 383 387 390 394 398 402 406 410 414 419 423 427 431 436 440 444 449 453 458 462 467 472 476 481 486 491 496 501 506 511 516 521 526 531 537 542 547 553 558 564 570 575 581 587 593 599 605 611 617 623 629 635 642 648 655 661 668 675 681 688 695 702 709 716 723 730 738 745 753 760 768 775 783 791 799 807 815 823 831 840 848 856 865 874 882 891 900 909 918 927 937 946 955 965 975 984 994 1004 1014 1024 1035 1045 1055 1066 1077 1087 1098 1109 1120 1132 1143 1154 1166 1177 1189 1201 1213 1225 1238 1250 1262 1275 1288 1301 1314 1327 1340 1353 1367 1381 1394 1408 1422 1437 1451 1466 1480 1495 1510 1525 1540 1556 1571 1587 1603 1619 1635 1651 1668 1685 1701 1718 1736 1753 1771 1788 1806 1824 1842 1861 1879 1898 1917 1936 1956 1975 1995 2015 2035 2056 2076 2097 2118 2139 2160 2182 2204 2226 2248 2271 2293 2316 2339 2363 2386 2410 2434 2459 2483 2508 2533 2558 2584 2610 2636 2662 2689 2716 2743 2770 2798 2826 2854 2883 2912 2941 2970 3000 3030 3060 3091 3122 3153 3185 3216 3249 3281 3314 3347 3380 3414 3448 3483 3518 3553 3588 3624 3661 3697 3734 3771 3809 3847 3886 3925 3964 4003 4044 4084 4125 4166 4208 4250 4292 4335 4379 4422 4467 4511 4556 4602 4648 4694 4741 4789 4837 4885 4934 4983 5033 5083 5134 5186 5237 5290 5343 5396 5450 5505 5560 5615 5671 5728 5785 5843 5902 5961 6020 6080 6141 6203 6265 6327 6391 6454 6519 6584 6650 6717 6784 6852 6920 6989 7059 7130 7201 7273 7346 7419 7493 7568 7644 7720 7798 7876 7954 8034 8114 8195 8277 8360 8444 8528 7324 8700 8787 8874 8963 9053 9143 9235 9327 9420 9515 9610 9706 9803 9901 1000000"
+1000000 2000 1.01: 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 1 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 3 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 4 5 5 5 5 5 5 5 5 5 5 5 5 5 5 5 5 5 5 5 5 6 6 6 6 6 6 6 6 6 6 6 6 6 6 6 6 6 7 7 7 7 7 7 7 7 7 7 7 7 7 7 8 8 8 8 8 8 8 8 8 8 8 8 8 9 9 9 9 9 9 9 9 9 9 9 10 10 10 10 10 10 10 10 10 10 11 11 11 11 11 11 11 11 11 12 12 12 12 12 12 12 12 12 13 13 13 13 13 13 13 14 14 14 14 14 14 14 14 15 15 15 15 15 15 16 16 16 16 16 16 16 17 17 17 17 17 17 18 18 18 18 18 19 19 19 19 19 20 20 20 20 20 21 21 21 21 21 22 22 22 22 22 23 23 23 23 24 24 24 24 25 25 25 25 26 26 26 26 27 27 27 27 28 28 28 28 29 29 29 30 30 30 31 31 31 31 32 32 32 33 33 33 34 34 34 35 35 35 36 36 37 37 37 38 38 38 39 39 40 40 40 41 41 42 42 42 43 43 44 44 45 45 45 46 46 47 47 48 48 49 49 50 50 51 51 52 52 53 53 54 54 55 55 56 57 57 58 58 59 59 60 61 61 62 62 63 64 64 65 66 66 67 68 68 69 70 70 71 72 73 73 74 75 75 76 77 78 79 79 80 81 82 83 83 84 85 86 87 88 89 89 90 91 92 93 94 95 96 97 98 99 100 101 102 103 104 105 106 107 108 109 110 111 112 114 115 116 117 118 119 120 122 123 124 125 127 128 129 130 132 133 134 136 137 138 140 141 143 144 146 147 148 150 151 153 155 156 158 159 161 162 164 166 167 169 171 172 174 176 178 179 181 183 185 187 189 190 192 194 196 198 200 202 204 206 208 210 212 215 217 219 221 223 226 228 230 232 235 237 239 242 244 247 249 252 254 257 259 262 264 267 270 272 275 278 281 283 286 289 292 295 298 301 304 307 310 313 316 319 323 326 329 332 336 339 342 346 349 353 356 360 364 367 371 375 378 382 386 390 394 398 402 406 410 414 418 422 426 431 435 439 444 448 453 457 462 466 471 476 480 485 490 495 500 505 510 515 520 525 531 536 541 547 552 558 563 569 575 580 586 592 598 604 610 616 622 628 635 641 647 654 660 667 674 680 687 694 701 708 715 722 730 737 744 752 759 767 774 782 790 798 806 814 822 830 839 847 855 864 873 881 890 899 908 917 926 936 945 954 964 974 983 993 1003 1013 1023 1033 1044 1054 1065 1075 1086 1097 1108 1119 1130 1142 1153 1165 1176 1188 1200 1212 1224 1236 1249 1261 1274 1286 1299 1312 1325 1339 1352 1366 1379 1393 1407 1421 1435 1450 1464 1479 1493 1508 1523 1539 1554 1570 1585 1601 1617 1633 1650 1666 1683 1700 1717 1734 1751 1769 1786 1804 1822 1841 1859 1878 1896 1915 1934 1954 1973 1993 2013 2033 2053 2074 2095 2116 2137 2158 2180 2202 2224 2246 2268 2291 2314 2337 2360 2384 2408 2432 2456 2481 2506 2531 2556 2581 2607 2633 2660 2686 2713 2740 2768 2795 2823 2852 2880 2909 2938 2967 2997 3027 3057 3088 3119 3150 3181 3213 3245 3278 3311 3344 3377 3411 3445 3479 3514 3549 3585 3621 3657 3694 3730 3768 3805 3843 3882 3921 3960 4000 4040 4080 4121 4162 4204 4246 4288 4331 4374 4418 4462 4507 4552 4597 4643 4690 4737 4784 4832 4880 4929 4978 5028 5078 5129 5180 5232 5285 5337 5391 5445 5499 5554 5610 5666 5722 5780 5837 5896 5955 6014 6074 6135 6197 6259 6321 6384 6448 6513 6578 6644 6710 6777 6845 6913 6982 7052 7123 7194 7266 7339 7412 7486 7561 7637 7713 7790 7868 7947 8026 8106 8187 8269 8352 8436 8520 8605 8691 8778 8866 8955 9044 9135 9226 9318 9411 9505 9600 9696 9793 9891 1000000
+lines 1 2048 2048 1
+1 2048 2048 1: ok
+lines 1 2047 32 1
+1 2047 32 1: ok
+lines 0 2048 100 1.01
+0 2048 100 1.01: ok
+lines 5 100 10 1.2
+5 100 10 1.2: ok
+lines 2 13 5 1.5
+2 13 5 1.5: ok
+lines 3 3 1 1
+3 3 1 1: ok
+sdft 64 8 hann
+64 8 hann: ok
+sdft 64 1 boxcar
+64 1 boxcar: ok
+sdft 65 7 flattop
+65 7 flattop: ok
+sdft 256 16 blackmanharris
+256 16 blackmanharris: ok
+sdft 100 100 hann
+100 100 hann: ok
+cq 1024 1024 1 10 hann
+1024 1024 1 10 hann: . . . . . . . . . .
+cq 1024 1024 4 24 hann
+1024 1024 4 24 hann: . . . . . . . . . . . . . . . . . . . . . . . .
+cq 1024 4096 16 24 hann
+1024 4096 16 24 hann: . . . . . . . . . . . . . . . . . . . . . . . .
+cq 256 256 2 12 boxcar
+256 256 2 12 boxcar: . . . . . . . . . . . .
+cq 1024 1024 4 40 blackmanharris
+1024 1024 4 40 blackmanharris: . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+scale 1 0 0 0 100 50
+1 0 0 0: 255 255
+scale 0.5 0 0 0 100 100 0 0
+0.5 0 0 0: 127 191 95 47
+scale 1 0.1 0 0 100 0 0 0 0
+1 0.1 0 0: 255 229 178 101 0
+scale 1 0.5 2 0 100 0 0 0 0 0
+1 0.5 2 0: 255 255 255 127 0 0
+scale 1 0 0 2 100 50 35 60
+1 0 0 2: 255 180 178 255
+scale 0.5 0.05 3 4 100 80 0 60 0 0 0 0 0 0 0
+0.5 0.05 3 4: 127 185 185 185 185 172 146 108 57 2 1
+format u8 1 1,2,255 3,4,5
+- 0102ff 030405 -
+format u8 2 1,2,255 3,4,5 6,7,8
+- - 0102ff030405 - 060708
+format db 1 255,128,1,0
+4153504e010101000400d0ff01000000 ffdf0000 -
+format u16 1 255,128,0
+4153504e010201000300000001000000 ffff80800000 -
+format f32 1 255,51,0
+4153504e010301000300000001000000 0000803fcdcc4c3e00000000 -
+format delta 1 1,2,3,4,5,6 1,2,3,4,5,6 1,9,3,4,5,7 0,9,3,4,6,7
+4153504e010401000600000001000000 0185010203040506 0005 00008009028007 00800002800600 -
+format delta 3 1,2,3,4 5,2,6,4 5,2,6,4
+4153504e010401000400000001000000 - - 0183010203040082050206000003 -
+format u16 0 65535
+u16 65535: ok
+format f32 0 65536
+f32 65536: -o needs l <= 65535 for the header
+format u8 0 524288
+u8 524288: ok
+shm 8 4 100000
+8 4 100000: ASPM 8 0 -1 -1 1 1 0, ok
+shm 4000 2 100000
+4000 2 100000: ASPM 4000 0 -1 -1 1 1 0, ok
+shm 65535 16 0
+65535 16 0: ok
+shm 65536 16 0
+65536 16 0: -M needs l <= 65535
+lib 1024 1024 1 1
+1024 1024 1 1: -l out of limit, 97 spectrums, ok
+lib 1024 256 2 4
+1024 256 2 4: -l out of limit, 774 spectrums, ok
+lib 2048 3000 1 3
+2048 3000 1 3: -l out of limit, 33 spectrums, ok
+fixed 32 32 15 hann
+32 32 15 hann 10000: ok
+fixed 1000 1024 100 blackmanharris
+1000 1024 100 blackmanharris 10000: ok
+fixed 256 1024 511 boxcar 32767
+256 1024 511 boxcar 32767: ok
+fixed 4096 4096 32 flattop 30000
+4096 4096 32 flattop 30000: ok
+fixed 16 16 7 boxcar 100
+16 16 7 boxcar 100: ok
+band 4096 4096 2 4 auto
+4096 4096 2 4 auto: goertzel ok
+band 4096 4096 2 300 auto
+4096 4096 2 300 auto: fft ok
+band 1024 1024 2 5 auto
+1024 1024 2 5 auto: pruned ok
+band 300 1024 5 9 goertzel 4
+300 1024 5 9 goertzel: goertzel ok
+band 1024 1024 500 511 pruned 3
+1024 1024 500 511 pruned: pruned ok
+band 2048 4096 1700 2047 pruned
+2048 4096 1700 2047 pruned: pruned ok
+band 32 32 1 15 pruned
+32 32 1 15 pruned: pruned ok
+band 512 4096 1 2047 padded
+512 4096 1 2047 padded: padded ok
+band 100 4096 10 40 padded 3
+100 4096 10 40 padded: padded ok
+band 33 128 60 63 padded
+33 128 60 63 padded: padded ok
+band 16 4096 1 2047 auto
+16 4096 1 2047 auto: padded ok
+decim 8 256 256 0.5
+8 256 256 0.5: passband, overlap ok
+decim 8 256 64 0.5
+8 256 64 0.5: passband, overlap ok
+decim 4 100 1 0.1
+4 100 1 0.1: passband, overlap ok
+decim 8 256 100 1.5
+8 256 100 1.5: stopband, overlap ok
+decim 3 512 512 2.5
+3 512 512 2.5: stopband, overlap ok
+decim 64 64 16 1.25
+64 64 16 1.25: stopband, overlap ok"
 
 
 
@@ -101,6 +227,9 @@ run() {
   fi
 }
 
+# With EXES set (make FIXED=1 builds fewer programs) the tests of the other
+# programs are skipped
+SKIPPED=0
 IFS=$'\n'
 COMMAND=
 for LINE in $TESTS; do
@@ -109,10 +238,15 @@ for LINE in $TESTS; do
     continue
   fi
 
-  run "$COMMAND" "$LINE"
+  if [ -n "$EXES" ] && [[ " $EXES " != *" ${COMMAND%% *} "* ]]; then
+    (( SKIPPED ++ ))
+  else
+    run "$COMMAND" "$LINE"
+  fi
   COMMAND=
 done
 
 echo $'\e[2K\r'"Number of tests:  $(printf %4d $(( OK + FAILED )))"
+[ $SKIPPED -gt 0 ] && echo "Skipped tests:    $(printf %4d $SKIPPED)"
 echo $'\e[33mFailed\e[m' "tests:     $(printf %4d $FAILED)"
 echo $'\e[32mSuccessful\e[m' "tests: $(printf %4d $OK)"
@@ -0,0 +1,46 @@
+#include <asa.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define Y_DBG_MAIN
+#include <y_dbg.h>
+
+#define L 7 // lines, so the simd kernels have a tail
+
+__attribute__((noreturn))
+static void usage() {
+  fprintf(stderr, "Usage: scale <smooth> <gravity> <hold> <gain> <m>...\n"
+      "  where: 0 < smooth <= 1; 0 <= gravity <= 1; 0 <= hold; 0 <= gain;\n"
+      "  for every magnitude m a spectrum of lines of m with maximum m is\n"
+      "  scaled, prints the lines as u8 (! if the lines differ)\n");
+  exit(1);
+}
+
+int main(int argc, char **argv) {
+  if (argc < 6) usage();
+  struct asa_struct_t asa = {
+    .param = {
+      .l = L, .c = 1, .smooth = strtod(argv[1], NULL),
+      .gravity = strtod(argv[2], NULL), .hold = strtoul(argv[3], NULL, 10),
+      .gain = strtoul(argv[4], NULL, 10),
+    },
+  };
+  if (asa.param.smooth <= 0 || asa.param.smooth > 1) usage();
+  asa_init_scale(&asa);
+
+  asa_real_t d[L], v[L];
+  asa.d = d;
+  printf("%s %s %s %s:", argv[1], argv[2], argv[3], argv[4]);
+  for (int i = 5; i < argc; i++) {
+    asa.max_mag = strtod(argv[i], NULL);
+    for (int j = 0; j < L; j++) d[j] = asa.max_mag;
+    asa_scale(&asa, v);
+
+    // like the u8 output format
+    printf(" %d", (uint8_t)v[0]);
+    for (int j = 1; j < L; j++) if (v[j] != v[0]) printf("!");
+  }
+  puts("");
+
+  free(asa.smooth);
+}
@@ -0,0 +1,89 @@
+#include <asa.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define Y_DBG_MAIN
+#include <y_dbg.h>
+
+__attribute__((noreturn))
+static void usage() {
+  fprintf(stderr, "Usage: sdft <n> <d> <window> [sequences]\n"
+      "  where: 4 <= n <= 4096; 1 <= d <= n; window one of:");
+  for (int i = 0; i <= W_LAST; i++)
+    fprintf(stderr, " %s", window_names[i]);
+  fputs("\n  compares the sliding dft engine with a dft of every sequence\n"
+      "  (default 1000 sequences)\n", stderr);
+  exit(1);
+}
+
+int main(int argc, char **argv) {
+  if (argc < 4 || argc > 5) usage();
+  int n = strtoul(argv[1], NULL, 10);
+  if (n < 4 || n > 4096) usage();
+  int d = strtoul(argv[2], NULL, 10);
+  if (d < 1 || d > n) usage();
+  int w;
+  for (w = W_FIRST; w <= W_LAST; w++)
+    if (0 == strcmp(argv[3], window_names[w])) break;
+  if (w > W_LAST) usage();
+  int count = argc == 5 ? strtoul(argv[4], NULL, 10) : 1000;
+
+  // All bins, so the tracked bins reach below 0 and above n / 2
+  struct asa_struct_t asa = {
+    .param = {
+      .s = n, .n = n, .m = 1 + n / 2,
+      .b0 = 0, .b1 = n / 2, .b = 1 + n / 2,
+      .p = 1.0, .l = 1 + n / 2,
+      .r = 1, .d = d, .w = w, .e = E_ESTIMATE, .k = 1, .t = 1, .c = 1,
+      .engine = X_SDFT,
+    },
+  };
+  asa.param.g = asa_distribute_bins(asa.param.l, asa.param.b, asa.param.p);
+  asa_init_fft(&asa);
+
+  const int len = n + count * d;
+  int16_t *s16le = malloc(sizeof(int16_t) * len);
+  if (!s16le) y_oom();
+  srand(0);
+  for (int i = 0; i < len; i++)
+    s16le[i] = 8000 * sin(i * 0.3) + 3000 * sin(i * 1.7) + rand() % 2000;
+
+  // Relative to the largest bin, the sliding dft uses the periodic window
+  const double *a = window_cosines[w];
+  double max_error = 0;
+  for (int q = 0; q < count; q++) {
+    asa.s16le = s16le + q * d;
+    asa_batch_slot(&asa, 0);
+    asa_pad_and_window(&asa);
+    asa_run_fft(&asa);
+
+    double error = 0, max = 0;
+    for (int k = 0; k < asa.param.m; k++) {
+      double re = 0, im = 0;
+      for (int i = 0; i < n; i++) {
+        double x = 2 * M_PI * i / n;
+        double v = asa.s16le[i] * (a[0] - a[1] * cos(x) + a[2] * cos(2 * x)
+          - a[3] * cos(3 * x) + a[4] * cos(4 * x));
+        re += v * cos(x * k);
+        im -= v * sin(x * k);
+      }
+      max = fmax(max, hypot(re, im));
+      error = fmax(error, hypot(re - asa.c[k][0], im - asa.c[k][1]));
+    }
+    max_error = fmax(max_error, error / max);
+  }
+
+#ifdef ASA_FLOAT
+  const double limit = 1e-5;
+#else
+  const double limit = 1e-9;
+#endif
+  printf("%d %d %s: ", n, d, window_names[w]);
+  if (max_error < limit) puts("ok");
+  else printf("error %g\n", max_error);
+
+  free(s16le);
+  free(asa.param.g);
+  asa_cleanup(&asa);
+}
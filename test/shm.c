@@ -0,0 +1,124 @@
+#include <asa.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define Y_DBG_MAIN
+#include <y_dbg.h>
+
+__attribute__((noreturn))
+static void usage() {
+  fprintf(stderr, "Usage: shm <l> <slots> <frames>\n"
+      "  where: 1 <= l <= 4096; 2 <= slots <= 4096; frames >= 1\n"
+      "  publishes frames of l lines to a shared memory ring of slots, read\n"
+      "  back by a consumer mapping it: first one after the other, then\n"
+      "  the latest while a thread publishes, checks no frame is torn;\n"
+      "  with frames 0 prints whether -M takes l lines of an fft of 2^20\n"
+      "  samples (1 <= l <= 2^19)\n");
+  exit(1);
+}
+
+static struct asa_struct_t asa;
+static asa_real_t *lines;
+static long frames;
+
+// Frame num has all lines num % 251
+static void publish(long num) {
+  for (int i = 0; i < asa.param.l; i++) lines[i] = num % 251;
+  asa_write(&asa);
+}
+
+static void *writer(void *arg) {
+  for (long num = 3 * asa.param.slots; num < frames; num++) publish(num);
+  return NULL;
+}
+
+// 1 if the frame is num, -1 if torn
+static int check(const uint8_t *frame, long num) {
+  for (int i = 0; i < asa.param.l; i++) if (frame[i] != num % 251) return -1;
+  return 1;
+}
+
+// The parameters of auspan -M /name,slots -s 2^20 -l l
+static void check_param(int l, int slots) {
+  const int n = 1 << 20;
+  const asa_param_t p = {
+    .s = n, .n = n, .m = 1 + n / 2, .b0 = 1, .b1 = n / 2, .b = n / 2,
+    .p = 1.0, .l = l, .r = 1, .d = n, .rate = 44100, .decim = 1,
+    .w = W_HANN, .e = E_ESTIMATE, .k = 1, .t = 1, .c = 1,
+    .engine = X_GOERTZEL, // of every build, also make FIXED=1
+    .smooth = 1, .format = O_U8, .join = 1, .shm = "/auspan",
+    .slots = slots,
+  };
+  const char *error = asa_check_param(&p);
+  printf("%d %d 0: %s\n", l, slots, error ? error : "ok");
+}
+
+int main(int argc, char **argv) {
+  if (argc != 4) usage();
+  int l = strtoul(argv[1], NULL, 10), slots = strtoul(argv[2], NULL, 10);
+  frames = strtol(argv[3], NULL, 10);
+  if (frames == 0 && l >= 1 && l <= 1 << 19) {
+    check_param(l, slots);
+    return 0;
+  }
+  if (l < 1 || l > 4096 || slots < 2 || slots > 4096 || frames < 1) usage();
+
+  char name[32];
+  snprintf(name, sizeof(name), "/auspan-test-%d", getpid());
+  asa = (struct asa_struct_t){
+    .param = {
+      .l = l, .c = 1, .d = 1, .r = 1, .b0 = 1, .b1 = 1, .smooth = 1,
+      .format = O_U8, .join = 1, .shm = name, .slots = slots,
+    },
+    .fd_out = -1, .max_mag = 255,
+  };
+  lines = asa.d = malloc(sizeof(*lines) * l);
+  uint8_t *frame = malloc(l);
+  if (!lines || !frame) y_oom();
+  asa_init_output(&asa);
+
+  // The consumer maps it read-only
+  int fd = shm_open(name, O_RDONLY, 0);
+  struct stat st;
+  if (fd == -1 || fstat(fd, &st) == -1) y_error("shm: %s", y_strerr);
+  const asa_shm_t *shm = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  if (shm == MAP_FAILED) y_error("mmap: %s", y_strerr);
+  close(fd);
+
+  printf("%d %d %ld: %.4s %d", l, slots, frames, shm->magic, shm->frame);
+  printf(" %d", asa_shm_read(shm, 0, frame));
+  for (long num = 0; num < 3 * slots; num++) publish(num);
+  const uint64_t head = atomic_load(&shm->head);
+  printf(" %d", asa_shm_read(shm, 0, frame));
+  printf(" %d", asa_shm_read(shm, head - slots - 1, frame));
+  int result = asa_shm_read(shm, head - slots, frame);
+  printf(" %d", result == 1 ? check(frame, head - slots) : result);
+  result = asa_shm_read(shm, head - 1, frame);
+  printf(" %d", result == 1 ? check(frame, head - 1) : result);
+  printf(" %d", asa_shm_read(shm, head, frame));
+
+  // The latest frame while they are published
+  pthread_t thread;
+  if (pthread_create(&thread, NULL, writer, NULL)) y_error("pthread_create");
+  long read = 0, torn = 0;
+  uint64_t num;
+  while ((num = atomic_load(&shm->head)) < (uint64_t)frames) {
+    if (asa_shm_read(shm, num - 1, frame) != 1) continue;
+    if (check(frame, num - 1) == 1) read++;
+    else torn++;
+  }
+  pthread_join(thread, NULL);
+  if (torn) printf(", %ld torn\n", torn);
+  else puts(", ok");
+  y_dbg("%ld frames read while publishing", read);
+
+  munmap((void*)shm, st.st_size);
+  free(frame);
+  asa_cleanup(&asa);
+  free(lines);
+}
@@ -10,7 +10,9 @@ function usage(msg)
 
     Usage: $PROGRAM_FILE [-l number-of-lines] [input-file]
     where number-of-lines is a number in range from 1 to 9999, default 32
-    and input-file is a file name with the u8 spectrum, default asa-spectrum
+    and input-file is a file name with the u8 spectrum, default asa-spectrum;
+    output of auspan -o starts with a header giving the format (db, u16, f32
+    or delta) and the number of lines, then -l is not needed
     """)
   exit(1)
 end
@@ -41,7 +43,67 @@ end
 
 l, ifile = parse_args()
 
-println("Audio Spectrum with $l line(s)")
+# Output of auspan -o starts with a header (see asa.h), else it's raw u8 and
+# the bytes read for the header are the first lines
+formats = ["u8", "db", "u16", "f32", "delta"]
+format = "u8"
+spectra = 1
+pending = read(ifile, 16)
+if length(pending) == 16 && pending[1:4] == Vector{UInt8}("ASPN")
+  format = formats[pending[6] + 1]
+  spectra = Int(pending[7])
+  l = Int(pending[9]) | Int(pending[10]) << 8
+  pending = UInt8[]
+end
+
+# n bytes, the pending ones first
+function take(n)
+  global pending
+  k = min(n, length(pending))
+  data = pending[1:k]
+  pending = pending[k + 1:end]
+  if k < n append!(data, read(ifile, n - k)) end
+  return data
+end
+
+# The next spectrum of channel c as u8 or nothing at the end
+prev = [zeros(UInt8, l) for c in 1:spectra]
+function next_spectrum(c)
+  if format == "u8" || format == "db"
+    data = take(l)
+    return length(data) == l ? data : nothing
+  elseif format == "u16"
+    data = take(2 * l)
+    return length(data) == 2 * l ? data[2:2:end] : nothing
+  elseif format == "f32"
+    data = take(4 * l)
+    if length(data) != 4 * l return nothing end
+    return [UInt8(floor(255 * clamp(ltoh(v), 0, 1)))
+      for v in reinterpret(Float32, data)]
+  end
+
+  # delta: key byte, then tokens: skip t + 1 lines or t - 127 new lines
+  key = take(1)
+  if length(key) != 1 return nothing end
+  if key[1] == 1 fill!(prev[c], 0) end
+  j = 0
+  while j < l
+    t = take(1)
+    if length(t) != 1 return nothing end
+    if t[1] < 128
+      j += t[1] + 1
+    else
+      n = t[1] - 127
+      data = take(n)
+      if length(data) != n return nothing end
+      prev[c][j + 1:j + n] = data
+      j += n
+    end
+  end
+  return copy(prev[c])
+end
+
+println("Audio Spectrum with $l line(s), $format")
 println('-' ^ 69)
 print("\n" ^ l);
 println('-' ^ 69)
@@ -54,10 +116,12 @@ blocks = [" ", "▏", "▎", "▍", "▌", "▋", "▊", "▉"]
 # https://stackoverflow.com/a/29270413
 ccall(:jl_exit_on_sigint, Nothing, (Cint,), 0)
 i = 0
+num = 0
 try
   while true
-    spectrum = read(ifile, l)
-    if length(spectrum) != l break end
+    spectrum = next_spectrum(num % spectra + 1)
+    if spectrum === nothing break end
+    global num += 1
 
     for i in 1:l
       @printf("%3d ", spectrum[i])
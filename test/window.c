@@ -25,7 +25,7 @@ int main(int argc, char **argv) {
   if (w > W_LAST) usage();
 
   int16_t s16le[n];
-  double d[n];
+  asa_real_t d[n];
 
   struct asa_struct_t asa = { 
     .s16le = s16le, 
@@ -37,6 +37,7 @@ int main(int argc, char **argv) {
 
   for (int i = 0; i < n; i++) s16le[i] = 10000;
 
+  asa_init_window(&asa);
   asa_pad_and_window(&asa);
 
   printf("%d %s:", n, window_names[w]);
@@ -0,0 +1,3 @@
+// The globals of y_dbg.h for auspan and libauspan
+#define Y_DBG_MAIN
+#include "y_dbg.h"